@@ -25,6 +25,14 @@ struct AppState {
 
     RegionCache region_cache;
     bool region_cache_needs_update = true;
+    // how far the map texture and the region cache have read the tile changes of the match
+    TileChangeJournal::Cursor map_texture_cursor = 0;
+    TileChangeJournal::Cursor region_cache_cursor = 0;
+    // the map chunks where a tile changed owner since the last frame, the map texture
+    // is the only one taking them from the match
+    std::vector<unsigned> map_texture_dirty_chunks;
+    // the tiles already written to the map texture this frame
+    TileStampSet map_texture_written_tiles;
 
     SDL_FRect dst_map_to_display;
 
@@ -49,6 +57,9 @@ struct AppState {
           match {map.get_width(), map.get_height()}, pyramid_renderer {}, profiler_enabled {false}
           {
         player_country_id = match.new_country("Player", true, {0,0,0}).get_id();
+        // the texture and the cache start from the whole map
+        map_texture_cursor = region_cache_cursor = match.get_tile_changes().get_cursor();
+        map_texture_written_tiles.reset(match.get_map().get_tile_index_count());
     };
 };
 
@@ -50,6 +50,19 @@ SDL_Texture *init_map_texture(SDL_Renderer *renderer, const Match &match) {
     if (!texture)
         return nullptr;
 
+    auto format = SDL_GetPixelFormatDetails(texture->format);
+    CQ_LOG_DEBUG << "Allocating " << width * height * format->bytes_per_pixel << " bytes for map texture\n";
+    CQ_LOG_DEBUG << "Height is " << height << " and width is " << width << " and bytes per pixel is " << (short)format->bytes_per_pixel << '\n';
+
+    fill_map_texture(texture, match);
+
+    return texture;
+}
+
+void fill_map_texture(SDL_Texture *texture, const Match &match) {
+    const Map &map = match.get_map();
+    unsigned width = map.get_width(), height = map.get_height();
+
     int pitch = 0;
     auto format = SDL_GetPixelFormatDetails(texture->format);
     uint8_t *pixels = nullptr;
@@ -57,11 +70,7 @@ SDL_Texture *init_map_texture(SDL_Renderer *renderer, const Match &match) {
     bool locked = SDL_LockTexture(texture, NULL, (void**)&pixels, &pitch);
     CONQORIAL_ASSERT_ALL(locked, SDL_GetError());
     if (!locked)
-        return nullptr;
-
-    auto size = width * height * format->bytes_per_pixel;
-    CQ_LOG_DEBUG << "Allocating " << size << " bytes for map texture\n";
-    CQ_LOG_DEBUG << "Height is " << height << " and width is " << width << " and pitch is " << pitch << " and bytes per pixel is " << (short)format->bytes_per_pixel << '\n';
+        return;
 
     for (unsigned y = 0; y < height; y++) {
         for (unsigned x = 0; x < width; x++) {
@@ -75,8 +84,6 @@ SDL_Texture *init_map_texture(SDL_Renderer *renderer, const Match &match) {
     }
 
     SDL_UnlockTexture(texture);
-
-    return texture;
 }
 
 void draw_map_texture(SDL_Texture *texture, SDL_Renderer *renderer, SDL_FRect dst_rect) {
@@ -97,22 +104,53 @@ void zoom_map(float zoom_factor, float center_x, float center_y, AppState &state
     state.dst_map_to_display.y = center_y - offsetY * zoom_factor;
 }
 
-void sync_map_texture(SDL_Texture *texture, const Match &match, const std::vector<std::pair<TileCoor, TileCoor>> &tiles_to_update) {
-    if (!tiles_to_update.empty()) {
-        uint8_t *pixels = nullptr;
-        int pitch = 0;
-        auto format = SDL_GetPixelFormatDetails(texture->format);
-        SDL_LockTexture(texture, NULL, (void**)&pixels, &pitch);
-        for (auto [x, y] : tiles_to_update) {
-            MapTile tile = match.get_map().get_tile(x, y);
-            auto color = get_tile_display_color(tile, match);
-            pixels[y * pitch + x * format->bytes_per_pixel] = color.r;
-            pixels[y * pitch + x * format->bytes_per_pixel + 1] = color.g;
-            pixels[y * pitch + x * format->bytes_per_pixel + 2] = color.b;
-            pixels[y * pitch + x * format->bytes_per_pixel + 3] = color.a;
+void sync_map_texture(SDL_Texture *texture, const Match &match, const TileChangeJournal::Delta &changes,
+                      const std::vector<unsigned> &dirty_chunks, TileStampSet &written_tiles) {
+    const Map &map = match.get_map();
+    if (changes.overflowed && !map.has_chunks()) {
+        CQ_LOG_DEBUG << "Too many tiles changed since the last frame, drawing the whole map again\n";
+        fill_map_texture(texture, match);
+        return;
+    }
+    if (changes.empty())
+        return;
+
+    uint8_t *pixels = nullptr;
+    int pitch = 0;
+    auto format = SDL_GetPixelFormatDetails(texture->format);
+    SDL_LockTexture(texture, NULL, (void**)&pixels, &pitch);
+    if (changes.overflowed) {
+        // the changes are lost, but the chunks they were in are known
+        CQ_LOG_DEBUG << "Too many tiles changed since the last frame, drawing " << dirty_chunks.size() << " chunks again\n";
+        for (unsigned chunk : dirty_chunks) {
+            TileArea area = map.get_chunks().get_chunk_area(chunk);
+            for (unsigned y = area.y_begin; y < area.y_end; y++) {
+                for (unsigned x = area.x_begin; x < area.x_end; x++) {
+                    auto color = get_tile_display_color(map.get_tile(x, y), match);
+                    pixels[y * pitch + x * format->bytes_per_pixel] = color.r;
+                    pixels[y * pitch + x * format->bytes_per_pixel + 1] = color.g;
+                    pixels[y * pitch + x * format->bytes_per_pixel + 2] = color.b;
+                    pixels[y * pitch + x * format->bytes_per_pixel + 3] = color.a;
+                }
+            }
         }
         SDL_UnlockTexture(texture);
+        return;
     }
+    // a tile can change owner several times between 2 frames, it is written once with its current owner
+    written_tiles.next_generation();
+    changes.for_each([&](const TileChange &change) {
+        if (!written_tiles.mark(change.tile))
+            return;
+        auto [x, y] = map.get_tile_coors(change.tile);
+        MapTile tile = map.get_tile(change.tile);
+        auto color = get_tile_display_color(tile, match);
+        pixels[y * pitch + x * format->bytes_per_pixel] = color.r;
+        pixels[y * pitch + x * format->bytes_per_pixel + 1] = color.g;
+        pixels[y * pitch + x * format->bytes_per_pixel + 2] = color.b;
+        pixels[y * pitch + x * format->bytes_per_pixel + 3] = color.a;
+    });
+    SDL_UnlockTexture(texture);
 }
 
 std::optional<std::pair<TileCoor, TileCoor>> convert_screen_to_map_coors(float x, float y, const AppState &state) {
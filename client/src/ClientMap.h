@@ -4,6 +4,7 @@
 #include "AppState.h"
 #include "SDL3/SDL.h"
 #include "Match.h"
+#include <vector>
 
 SDL_Color get_tile_color(MapTileType type);
 
@@ -11,7 +12,14 @@ SDL_Color get_tile_display_color(const MapTile &tile, const Match &match);
 
 SDL_Texture *init_map_texture(SDL_Renderer *renderer, const Match &match);
 
-void sync_map_texture(SDL_Texture *texture, const Match &match, const std::vector<std::pair<TileCoor, TileCoor>> &tiles_to_update);
+// draws every tile of the map to the texture again
+void fill_map_texture(SDL_Texture *texture, const Match &match);
+
+// draws the tiles that changed to the texture
+// if the changes overflowed it draws the dirty chunks again (the whole map if the map has no chunks)
+// written_tiles (sized for the tiles of the map) makes sure every tile is only written once
+void sync_map_texture(SDL_Texture *texture, const Match &match, const TileChangeJournal::Delta &changes,
+                      const std::vector<unsigned> &dirty_chunks, TileStampSet &written_tiles);
 
 void draw_map_texture(SDL_Texture *texture, SDL_Renderer *renderer, SDL_FRect src_rect);
 
@@ -112,18 +112,32 @@ void find_largest_rectangle(const std::vector<bool>& grid,
 
 // Find regions for a country with their largest inscribed rectangles
 void find_country_regions_with_rectangles(const Map& map, CountryId country_id,
+                                        const TileArea& country_bounds,
                                         std::vector<RegionWithRectangle>& output,
-                                        const std::map<CountryId, Country>& countries) {
+                                        const CountryTable& countries) {
     PROFILE_SECTION("find_country_regions_with_rectangles");
     const int min_region_area = 25;
     const int map_width = map.get_width();
     const int map_height = map.get_height();
-    std::vector<bool> visited(map_width * map_height, false);
+    // indexed by TileIndex, the water ring around the map is never visited since nobody owns it
+    std::vector<bool> visited(map.get_tile_index_count(), false);
     
-    for (int y = 0; y < map_height; ++y) {
-        for (int x = 0; x < map_width; ++x) {
-            int index = y * map_width + x;
-            if (visited[index] || map.get_tile(x, y).owner != country_id) continue;
+    // only the chunks where the country has tiles can contain the start of a region,
+    // and only the part of them inside the bounds of the country
+    std::vector<TileArea> areas;
+    map.for_each_area_owned_by(country_id, [&areas, &country_bounds](const TileArea &area) {
+        TileArea clipped = area.intersect(country_bounds);
+        if (!clipped.is_empty())
+            areas.push_back(clipped);
+    });
+
+    for (const TileArea &area : areas)
+    for (int y = area.y_begin; y < (int)area.y_end; ++y) {
+        // only the owner plane is read while looking for the start of a region
+        // (through the index, so this works with every tile layout)
+        for (int x = area.x_begin; x < (int)area.x_end; ++x) {
+            TileIndex index = map.get_tile_index(x, y);
+            if (map.get_owner(index) != country_id || visited[index]) continue;
             
             RegionWithRectangle region;
             
@@ -159,22 +173,17 @@ void find_country_regions_with_rectangles(const Map& map, CountryId country_id,
                 sum_y += curr.y + 0.5;
                 tile_count++;
                 
-                // Unrolled neighbor checking for better performance
-                // Check all four neighbors using direction arrays
-                const int dx[4] = {-1, 1, 0, 0}; // left, right, top, bottom
-                const int dy[4] = {0, 0, -1, 1}; // left, right, top, bottom
-                
-                for (int dir = 0; dir < 4; dir++) {
-                    int nx = curr.x + dx[dir];
-                    int ny = curr.y + dy[dir];
-                    
-                    // Check if neighbor is within bounds
-                    if (nx >= 0 && nx < map_width && ny >= 0 && ny < map_height) {
-                        int neighbor_index = ny * map_width + nx;
-                        if (!visited[neighbor_index] && map.get_tile(nx, ny).owner == country_id) {
-                            visited[neighbor_index] = true;
-                            queue.push_back({nx, ny});
-                        }
+                // The neighbors come from index deltas, no bounds checks are needed
+                // because the tiles of the water ring are owned by nobody
+                // and only the land neighbors are read
+                TileIndex curr_index = map.get_tile_index(curr.x, curr.y);
+                auto neighbors = map.get_tile_neighbors(curr_index);
+                for (unsigned land = map.get_land_neighbors(curr_index); land != 0; land &= land - 1) {
+                    int dir = __builtin_ctz(land);
+                    TileIndex neighbor_index = neighbors[dir];
+                    if (!visited[neighbor_index] && map.get_owner(neighbor_index) == country_id) {
+                        visited[neighbor_index] = true;
+                        queue.push_back({curr.x + neighbor_directionsCE[dir][0], curr.y + neighbor_directionsCE[dir][1]});
                     }
                 }
             }
@@ -222,8 +231,7 @@ void find_country_regions_with_rectangles(const Map& map, CountryId country_id,
             
             region.area = static_cast<float>(tile_count);
             
-            // Avoid map lookup with .at() for better performance
-            const auto& country = countries.find(country_id)->second;
+            const auto& country = countries.at(country_id);
             const auto& color = country.get_color();
             region.color.r = color.r;
             region.color.g = color.g;
@@ -237,9 +245,28 @@ void find_country_regions_with_rectangles(const Map& map, CountryId country_id,
     }
 }
 
+void invalidate_region_cache(const TileChangeJournal::Delta& changes, RegionCache& cache) {
+    if (changes.overflowed) {
+        cache.clear();
+        return;
+    }
+
+    // only the regions of the 2 countries of a change can be different,
+    // the changes come in batches of the same 2 countries so most are skipped
+    const TileChange* last = nullptr;
+    changes.for_each([&cache, &last](const TileChange& change) {
+        if (last && last->old_owner == change.old_owner && last->new_owner == change.new_owner)
+            return;
+        cache.erase(change.old_owner);
+        cache.erase(change.new_owner);
+        last = &change;
+    });
+}
+
 void render_country_labels(SDL_Renderer* renderer, ImDrawList* draw_list,
                          const Map& map, const SDL_FRect& view_rect,
-                         const std::map<CountryId, Country>& countries,
+                         const CountryTable& countries,
+                         const TerritoryStats& territories,
                          RegionCache& cache, bool update_cache) {
     static const float map_width = static_cast<float>(map.get_width());
     static const float map_height = static_cast<float>(map.get_height());
@@ -258,21 +285,23 @@ void render_country_labels(SDL_Renderer* renderer, ImDrawList* draw_list,
     float map_to_screen_x = view_rect.w / map_width;
     float map_to_screen_y = view_rect.h / map_height;
     
-    // Update cache if needed
+    // Update cache if needed, only the countries invalidate_region_cache removed are computed again
     if (update_cache) {
-        cache.clear(); // Clear the cache to avoid stale data
-        
         CQ_LOG_DEBUG << "Updating region cache for country name rendering\n";
-        for (const auto& [country_id, country] : countries) {
-            if (country_id == 0) continue;
+        for (const Country& country : countries) {
+            CountryId country_id = country.get_id();
+            if (country_id == 0 || cache.count(country_id) != 0) continue;
             
             std::vector<RegionWithRectangle> regions;
-            regions.reserve(8); // Pre-allocate for typical number of regions
-            find_country_regions_with_rectangles(map, country_id, regions, countries);
-            
-            if (!regions.empty()) {
-                cache[country_id] = std::move(regions);
+            const CountryTerritory& territory = territories.get(country_id);
+            // countries without tiles have no regions, there is no need to look for them
+            if (territory.tile_count != 0) {
+                regions.reserve(8); // Pre-allocate for typical number of regions
+                find_country_regions_with_rectangles(map, country_id, territory.bounds, regions, countries);
             }
+            
+            // countries without regions are cached too so they are not searched every update
+            cache[country_id] = std::move(regions);
         }
     }
     
@@ -283,7 +312,8 @@ void render_country_labels(SDL_Renderer* renderer, ImDrawList* draw_list,
     };
     
     // Process each country using the cache
-    for (const auto& [country_id, country] : countries) {
+    for (const Country& country : countries) {
+        CountryId country_id = country.get_id();
         if (country_id == 0) continue; // Skip neutral territory
         
         // Use cached regions if available, otherwise compute them
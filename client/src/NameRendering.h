@@ -1,11 +1,14 @@
 #pragma once
 
 #include "Map.h"
+#include "TerritoryStats.h"
+#include "TileChangeJournal.h"
 #include "SDL3/SDL_pixels.h"
 #include "SDL3/SDL_render.h"
 #include "imgui.h"
 #include "typedefs.h"
 #include "Country.h"
+#include "CountryTable.h"
 #include <map>
 #include <unordered_map>
 #include "utils.h"
@@ -47,8 +50,13 @@ void find_largest_rectangle(const std::vector<bool>& grid,
                           const Coordinate& min_bounds, const Coordinate& max_bounds,
                           int& out_x, int& out_y, int& out_width, int& out_height);
 
+// removes the countries that gained or lost tiles in the changes from the cache
+// (all of them if the changes overflowed)
+void invalidate_region_cache(const TileChangeJournal::Delta& changes, RegionCache& cache);
+
 void render_country_labels(SDL_Renderer* renderer, ImDrawList* draw_list, 
                          const Map& map, const SDL_FRect& view_rect,
-                         const std::map<CountryId, Country>& countries,
+                         const CountryTable& countries,
+                         const TerritoryStats& territories,
                          RegionCache& cache, bool update_cache);
 
@@ -72,9 +72,16 @@ void draw_main_ui(AppState &state, unsigned long long frame_time) {
 
     Profiler::instance().start_frame("Render Map Names");
 
+    auto changes = state.match.get_tile_changes().read(state.region_cache_cursor);
+    if (!changes.empty()) {
+        invalidate_region_cache(changes, state.region_cache);
+        state.region_cache_needs_update = true;
+    }
+
     ImDrawList* draw_list = ImGui::GetBackgroundDrawList();
     render_country_labels(state.renderer, draw_list, state.match.get_map(),
                         state.dst_map_to_display, state.match.get_countries(),
+                        state.match.get_territory_stats(),
                         state.region_cache, state.region_cache_needs_update);
     state.region_cache_needs_update = false; // Reset after update
 
@@ -140,8 +147,8 @@ void display_tile_dialogs(AppState &state) {
 
     if (state.match.get_game_state() == GameState::SelectingStartingPoint) {
         if (ImGui::Button("Set Starting Point")) {
-            auto tiles_changed = state.match.spawn_country(state.player_country_id, mx, my);
-            sync_map_texture(state.map_texture, state.match, tiles_changed);
+            // the spawned tiles reach the texture through the tile change journal next frame
+            state.match.spawn_country(state.player_country_id, mx, my);
             state.match.set_game_started();
             state.selected_tile = std::nullopt;
         }
@@ -156,6 +163,7 @@ void display_tile_dialogs(AppState &state) {
     }
 
     if (tile.elevation >= MapTileType::Beach && tile.elevation < MapTileType::Grass &&
+            state.match.can_naval_invade(state.player_country_id, tile_index) &&
             ImGui::Button("Naval Invade")) {
         // TODO: Implement this
         CQ_LOG_DEBUG << "Naval invade\n";
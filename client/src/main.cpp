@@ -119,11 +119,15 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
 
     {
         PROFILE_SECTION("Match tick");
-        auto tiles_changed = state.match.tick();
-        if (!tiles_changed.empty()) {
-            sync_map_texture(state.map_texture, state.match, tiles_changed);
-            state.region_cache_needs_update = true;
-        }
+        // the texture reads the journal rather than the tiles tick() returns,
+        // the journal also has the tiles changed between frames (like spawns)
+        state.match.tick();
+        auto changes = state.match.get_tile_changes().read(state.map_texture_cursor);
+        // taken every frame so the chunks are the ones that changed since the last frame
+        state.map_texture_dirty_chunks.clear();
+        state.match.take_dirty_map_chunks(state.map_texture_dirty_chunks);
+        sync_map_texture(state.map_texture, state.match, changes, state.map_texture_dirty_chunks,
+                         state.map_texture_written_tiles);
     }
 
     ImGui_ImplSDL3_NewFrame();
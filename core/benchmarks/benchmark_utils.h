@@ -0,0 +1,105 @@
+#pragma once
+
+// Small helpers shared by the core benchmarks: timing repeated runs
+// and writing the results as JSON so runs can be compared by scripts.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+
+struct Result {
+    std::string name;
+    // extra parameters of this benchmark (eg. thread count), written to the JSON as is
+    std::map<std::string, double> parameters;
+    // how many operations each run did, used for the per operation time
+    unsigned long long operations_per_run = 1;
+    std::vector<double> runs_ms;
+
+    double min_ms() const {
+        return *std::min_element(runs_ms.begin(), runs_ms.end());
+    }
+
+    double median_ms() const {
+        std::vector<double> sorted = runs_ms;
+        std::sort(sorted.begin(), sorted.end());
+        return sorted[sorted.size() / 2];
+    }
+
+    double mean_ms() const {
+        double sum = 0.0;
+        for (double run : runs_ms)
+            sum += run;
+        return sum / runs_ms.size();
+    }
+};
+
+// runs setup (not timed) and then body (timed) repetitions times
+inline Result run(const std::string &name, unsigned repetitions, unsigned long long operations_per_run,
+                  const std::function<void()> &setup, const std::function<void()> &body) {
+    Result result;
+    result.name = name;
+    result.operations_per_run = operations_per_run;
+    for (unsigned i = 0; i < repetitions; i++) {
+        setup();
+        auto start = std::chrono::steady_clock::now();
+        body();
+        result.runs_ms.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return result;
+}
+
+inline Result run(const std::string &name, unsigned repetitions, unsigned long long operations_per_run,
+                  const std::function<void()> &body) {
+    return run(name, repetitions, operations_per_run, [] {}, body);
+}
+
+inline void write_json(std::ostream &out, const std::map<std::string, double> &parameters, const std::vector<Result> &results) {
+    out << "{\n  \"parameters\": {";
+    for (auto it = parameters.begin(); it != parameters.end(); ++it)
+        out << (it == parameters.begin() ? "" : ", ") << '"' << it->first << "\": " << it->second;
+    out << "},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result &result = results[i];
+        out << "    {\"name\": \"" << result.name << "\", \"parameters\": {";
+        for (auto it = result.parameters.begin(); it != result.parameters.end(); ++it)
+            out << (it == result.parameters.begin() ? "" : ", ") << '"' << it->first << "\": " << it->second;
+        out << "}, \"operations_per_run\": " << result.operations_per_run
+            << ", \"min_ms\": " << result.min_ms()
+            << ", \"median_ms\": " << result.median_ms()
+            << ", \"mean_ms\": " << result.mean_ms()
+            << ", \"median_ns_per_operation\": " << result.median_ms() * 1e6 / result.operations_per_run
+            << ", \"runs_ms\": [";
+        for (size_t run = 0; run < result.runs_ms.size(); run++)
+            out << (run == 0 ? "" : ", ") << result.runs_ms[run];
+        out << "]}" << (i + 1 == results.size() ? "" : ",") << '\n';
+    }
+    out << "  ]\n}\n";
+}
+
+// returns the value after --name in the arguments, or default_value if it is not there
+inline unsigned long get_argument(int argc, char *argv[], const char *name, unsigned long default_value) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], name) == 0)
+            return std::strtoul(argv[i + 1], nullptr, 10);
+    }
+    return default_value;
+}
+
+inline const char *get_string_argument(int argc, char *argv[], const char *name, const char *default_value) {
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::strcmp(argv[i], name) == 0)
+            return argv[i + 1];
+    }
+    return default_value;
+}
+
+} // namespace benchmark
+
@@ -0,0 +1,521 @@
+// Benchmarks for the hot paths of the core.
+// Every run is repeatable: the map and the territories only depend on the parameters.
+//
+// usage: Conqorial-Benchmarks [--width 1024] [--height 1024] [--countries 64]
+//                             [--repetitions 5] [--output results.json] [--filter name]
+// --filter only runs the benchmarks whose name contains the given text.
+// The results are written as JSON to the output file (or stdout) and a summary to stderr.
+
+#include "Attack.h"
+#include "AttackTable.h"
+#include "BorderSweep.h"
+#include "Country.h"
+#include "CountryTable.h"
+#include "Frontier.h"
+#include "Map.h"
+#include "OwnershipMask.h"
+#include "PopulationPyramid.h"
+#include "TerritoryIndex.h"
+#include "noise_wrapper.h"
+#include "ThreadPool.h"
+#include "benchmark_utils.h"
+#include "typedefs.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+// Everything an attack needs, split into a grid of countries
+// so every country (except the ones on the edges) has 4 neighbors
+struct World {
+    Map map;
+    CountryTable countries;
+    TerritoryIndex territory;
+
+    World(unsigned width, unsigned height, unsigned country_count, const MapSettings &settings = {}) : map {width, height, settings} {
+        territory.reset(map.get_tile_index_count());
+        countries.add(Country { 0, "Neutral", {0, 0, 0} });
+        for (unsigned id = 1; id <= country_count; id++) {
+            Country country { static_cast<CountryId>(id), "Country " + std::to_string(id), {0, 0, 0} };
+            country.set_target_mobilization_level(100);
+            country.calculate_troops();
+            countries.add(std::move(country));
+        }
+
+        unsigned grid_size = std::ceil(std::sqrt(country_count));
+        for (unsigned y = 0; y < height; y++) {
+            for (unsigned x = 0; x < width; x++) {
+                if (map.get_tile(x, y).type == MapTileType::Water)
+                    continue;
+                unsigned owner = 1 + (x * grid_size / width) + (y * grid_size / height) * grid_size;
+                if (owner > country_count)
+                    continue;
+                map.set_tile(x, y, owner);
+                territory.insert(owner, map.get_tile_index(x, y));
+            }
+        }
+    }
+
+    // what Match::transfer_tiles does, appends the tiles to tiles_changed
+    void transfer_tiles(Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner,
+                        std::vector<TileIndex> &tiles_changed) {
+        for (TileIndex tile : tiles) {
+            territory.erase(old_owner, tile);
+            territory.insert(new_owner, tile);
+        }
+        map.transfer_tiles(tiles, old_owner, new_owner);
+        tiles_changed.insert(tiles_changed.end(), tiles.begin(), tiles.end());
+    }
+
+    // advances the attack and gives the captured tiles to the attacker
+    bool advance(Attack &attack, TileStampSet &stamps, std::vector<TileIndex> &tiles_changed) {
+        if (!attack.advance(map, countries, stamps))
+            return false;
+        transfer_tiles(attack.get_captured_tiles(), attack.defender, attack.attacker, tiles_changed);
+        return true;
+    }
+};
+
+// what every benchmark gets: the command line parameters, a shared world split between
+// the countries (built once) and the results to append to
+struct Context {
+    unsigned width;
+    unsigned height;
+    unsigned country_count;
+    unsigned repetitions;
+    const World &world;
+    std::vector<benchmark::Result> &results;
+};
+
+// a benchmark appends its results to the context and returns false if the
+// code it measured gave a wrong result
+using BenchmarkFunction = bool (*)(Context &context);
+
+struct Benchmark {
+    const char *name;
+    BenchmarkFunction function;
+};
+
+// terrain generation with 1, 2, 4, ... threads up to the number of cores
+static bool benchmark_map_generation(Context &context) {
+    unsigned width = context.width, height = context.height;
+    unsigned max_threads = ThreadPool::resolve_thread_count(0);
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+        MapSettings settings;
+        settings.generation_threads = threads;
+        auto result = benchmark::run("map_generation", context.repetitions, width * height, [&] {
+            Map map {width, height, settings};
+        });
+        result.parameters["threads"] = threads;
+        context.results.push_back(result);
+        if (threads == max_threads)
+            break;
+    }
+    if (max_threads > 1) {
+        MapSettings serial_settings, parallel_settings;
+        serial_settings.generation_threads = 1;
+        parallel_settings.generation_threads = max_threads;
+        Map serial {width, height, serial_settings};
+        Map parallel {width, height, parallel_settings};
+        for (unsigned y = 0; y < height; y++) {
+            for (unsigned x = 0; x < width; x++) {
+                MapTile a = serial.get_tile(x, y), b = parallel.get_tile(x, y);
+                if (a.elevation != b.elevation || a.type != b.type) {
+                    std::cerr << "map_generation: the parallel terrain is different at " << x << ", " << y << '\n';
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// FastNoiseLite one sample at a time against the batch used by the map, with and without AVX2
+static bool benchmark_elevation(Context &context) {
+    unsigned width = context.width, height = context.height;
+    FastNoiseLite noise;
+    configure_noise(noise);
+    std::vector<Elevation> scalar_row(width), batch_row(width);
+    context.results.push_back(benchmark::run("elevation_scalar", context.repetitions, width * height, [&] {
+        for (unsigned y = 0; y < height; y++) {
+            for (unsigned x = 0; x < width; x++)
+                scalar_row[x] = get_elevation(noise, x, y);
+        }
+    }));
+
+    for (bool vectorize : {false, true}) {
+        ElevationBatch elevations {width, {}, vectorize};
+        if (vectorize && !elevations.is_vectorized())
+            break;
+        context.results.push_back(benchmark::run("elevation_batch", context.repetitions, width * height, [&] {
+            for (unsigned y = 0; y < height; y++)
+                elevations.get_row(y, 0, {batch_row.data(), batch_row.size()});
+        }));
+        context.results.back().parameters["vectorized"] = elevations.is_vectorized();
+
+        // both batches must give exactly the elevations of FastNoiseLite
+        for (unsigned y = 0; y < height; y++) {
+            elevations.get_row(y, 0, {batch_row.data(), batch_row.size()});
+            for (unsigned x = 0; x < width; x++) {
+                if (batch_row[x] != get_elevation(noise, x, y)) {
+                    std::cerr << "elevation_batch: differs from FastNoiseLite at " << x << ", " << y << '\n';
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// counting the tiles of a country through get_tile (all the fields) and through the owner rows
+static bool benchmark_owner_scan(Context &context) {
+    unsigned width = context.width, height = context.height;
+    const World &world = context.world;
+    context.results.push_back(benchmark::run("owner_scan_get_tile", context.repetitions, width * height, [&] {
+        unsigned owned = 0;
+        for (unsigned y = 0; y < height; y++) {
+            for (unsigned x = 0; x < width; x++)
+                owned += world.map.get_tile(x, y).owner == 1;
+        }
+        if (owned == 0)
+            std::cerr << "owner_scan_get_tile: country 1 has no tiles\n";
+    }));
+    context.results.push_back(benchmark::run("owner_scan_rows", context.repetitions, width * height, [&] {
+        unsigned owned = 0;
+        for (unsigned y = 0; y < height; y++) {
+            for (CountryId owner : world.map.get_owner_row(y))
+                owned += owner == 1;
+        }
+        if (owned == 0)
+            std::cerr << "owner_scan_rows: country 1 has no tiles\n";
+    }));
+    return true;
+}
+
+// the same count for every country through the chunk index
+static bool benchmark_count_owned_tiles(Context &context) {
+    const World &world = context.world;
+    context.results.push_back(benchmark::run("count_owned_tiles", context.repetitions, context.country_count, [&] {
+        unsigned owned = 0;
+        for (unsigned id = 1; id <= context.country_count; id++)
+            owned += world.map.count_owned_tiles(id, {0, 0, context.width, context.height});
+        if (owned == 0)
+            std::cerr << "count_owned_tiles: no tiles\n";
+    }));
+    return true;
+}
+
+// turning the tiles of the countries back into coordinates, and moving the tiles of country 1
+// to country 2 and back (which finds the chunk of every tile), with and without power of two rows
+static bool benchmark_tile_strides(Context &context) {
+    for (bool power_of_two_stride : {false, true}) {
+        MapSettings settings;
+        settings.power_of_two_stride = power_of_two_stride;
+        const World stride_world {context.width, context.height, context.country_count, settings};
+        const Map &map = stride_world.map;
+
+        std::vector<TileIndex> tiles;
+        for (unsigned id = 1; id <= context.country_count; id++) {
+            auto country_tiles = stride_world.territory.get_tiles(id);
+            tiles.insert(tiles.end(), country_tiles.begin(), country_tiles.end());
+        }
+        auto coors_result = benchmark::run("get_tile_coors", context.repetitions, tiles.size(), [&] {
+            unsigned long long sum = 0;
+            for (TileIndex tile : tiles) {
+                auto [x, y] = map.get_tile_coors(tile);
+                sum += x + y;
+            }
+            if (sum == 0)
+                std::cerr << "get_tile_coors: no coordinates\n";
+        });
+        coors_result.parameters["power_of_two_stride"] = power_of_two_stride;
+        coors_result.parameters["stride"] = map.get_row_stride();
+        context.results.push_back(coors_result);
+
+        Map transfer_map = map;
+        auto country_tiles = stride_world.territory.get_tiles(1);
+        std::vector<TileIndex> transferred(country_tiles.begin(), country_tiles.end());
+        auto transfer_result = benchmark::run("transfer_tiles", context.repetitions, transferred.size() * 2, [&] {
+            transfer_map.transfer_tiles({transferred.data(), transferred.size()}, 1, 2);
+            transfer_map.transfer_tiles({transferred.data(), transferred.size()}, 2, 1);
+        });
+        transfer_result.parameters["power_of_two_stride"] = power_of_two_stride;
+        context.results.push_back(transfer_result);
+    }
+    return true;
+}
+
+static bool benchmark_get_border(Context &context) {
+    const World &world = context.world;
+    context.results.push_back(benchmark::run("get_border", context.repetitions, context.country_count, [&] {
+        size_t border_tiles = 0;
+        for (unsigned id = 1; id <= context.country_count; id++)
+            border_tiles += world.map.get_border(id).border.size();
+        if (border_tiles == 0)
+            std::cerr << "get_border: no borders\n";
+    }));
+    context.results.push_back(benchmark::run("get_border_with_target", context.repetitions, context.country_count, [&] {
+        size_t border_tiles = 0;
+        for (unsigned id = 1; id < context.country_count; id++)
+            border_tiles += world.map.get_border(id, id + 1).border.size();
+        if (border_tiles == 0)
+            std::cerr << "get_border_with_target: no borders\n";
+    }));
+    return true;
+}
+
+// the borders of every country with one pass over the map, what the border index is rebuilt from
+static bool benchmark_border_sweep(Context &context) {
+    const World &world = context.world;
+    BorderSweep sweep;
+    context.results.push_back(benchmark::run("border_sweep", context.repetitions, context.width * context.height, [&] {
+        sweep.sweep(world.map);
+        if (sweep.get_pairs(1).empty())
+            std::cerr << "border_sweep: no borders\n";
+    }));
+    return true;
+}
+
+// the same borders by dilating ownership masks over the whole map
+static bool benchmark_get_border_with_masks(Context &context) {
+    const World &world = context.world;
+    BorderMasks masks;
+    std::vector<TileIndex> mask_border;
+    context.results.push_back(benchmark::run("get_border_with_masks", context.repetitions, context.country_count, [&] {
+        size_t border_tiles = 0;
+        for (unsigned id = 1; id < context.country_count; id++) {
+            mask_border.clear();
+            find_border_with_masks(world.map, id, id + 1, masks, mask_border);
+            border_tiles += mask_border.size();
+        }
+        if (border_tiles == 0)
+            std::cerr << "get_border_with_masks: no borders\n";
+    }));
+    return true;
+}
+
+static bool benchmark_can_attack(Context &context) {
+    const World &world = context.world;
+    unsigned country_count = context.country_count;
+    context.results.push_back(benchmark::run("can_attack", context.repetitions, (unsigned long long)country_count * country_count, [&] {
+        unsigned attackable = 0;
+        for (unsigned attacker = 1; attacker <= country_count; attacker++) {
+            const Country &country = world.countries.at(attacker);
+            for (unsigned defender = 1; defender <= country_count; defender++)
+                attackable += country.can_attack(defender, world.map);
+        }
+        if (attackable == 0)
+            std::cerr << "can_attack: nobody can attack\n";
+    }));
+    return true;
+}
+
+// what drawing the map texture does for every tile: find the owner and read one of its fields
+static bool benchmark_country_lookup(Context &context) {
+    const World &world = context.world;
+    context.results.push_back(benchmark::run("country_lookup", context.repetitions, world.map.get_tile_index_count(), [&] {
+        unsigned long long troops = 0;
+        for (TileIndex tile = 0; tile < world.map.get_tile_index_count(); tile++)
+            troops += world.countries.at(world.map.get_owner(tile)).get_troops();
+        if (troops == 0)
+            std::cerr << "country_lookup: nobody has troops\n";
+    }));
+    return true;
+}
+
+// country 1 attacks country 2 (its right neighbor) with all its troops until the attack stops
+static bool benchmark_attack_advance(Context &context) {
+    const World &world = context.world;
+    World attack_world = world;
+    Attack attack {1, 2, 0};
+    TileStampSet stamps;
+    std::vector<TileIndex> tiles_changed;
+    auto result = benchmark::run("attack_advance", context.repetitions, 1, [&] {
+        attack_world = world;
+        attack = Attack {1, 2, attack_world.countries.at(1).get_troops()};
+        stamps.reset(attack_world.map.get_tile_index_count());
+        tiles_changed.clear();
+    }, [&] {
+        while (attack_world.advance(attack, stamps, tiles_changed)) {}
+    });
+    result.operations_per_run = std::max<size_t>(tiles_changed.size(), 1);
+    result.parameters["tiles_captured"] = tiles_changed.size();
+    context.results.push_back(result);
+    return true;
+}
+
+// every country attacks its right neighbor with all its troops at the same time, like a match full of bots
+// the attacks of each run reuse the slots (and border buffers) of the last run
+static bool benchmark_concurrent_attacks(Context &context) {
+    const World &world = context.world;
+    World concurrent_world = world;
+    AttackTable attacks;
+    TileStampSet stamps;
+    std::vector<TileIndex> tiles_changed;
+    unsigned attack_count = 0;
+    auto result = benchmark::run("concurrent_attacks", context.repetitions, 1, [&] {
+        concurrent_world = world;
+        attack_count = 0;
+        for (unsigned id = 1; id < context.country_count; id++) {
+            if (!world.map.shares_border(id, id + 1))
+                continue;
+            attacks.start(id, id + 1, concurrent_world.countries.at(id).get_troops());
+            attack_count++;
+        }
+        stamps.reset(concurrent_world.map.get_tile_index_count());
+        tiles_changed.clear();
+    }, [&] {
+        while (attacks.size() != 0) {
+            attacks.update([&](Attack &attack) {
+                return concurrent_world.advance(attack, stamps, tiles_changed);
+            });
+        }
+    });
+    result.operations_per_run = std::max<size_t>(tiles_changed.size(), 1);
+    result.parameters["attacks"] = attack_count;
+    result.parameters["tiles_captured"] = tiles_changed.size();
+    context.results.push_back(result);
+    return true;
+}
+
+// the same 2D neighborhood walks on both tile layouts:
+// a flood fill of country 1 and country 1 attacking country 2
+static bool benchmark_tile_layouts(Context &context) {
+    for (TileLayout layout : {TileLayout::RowMajor, TileLayout::Morton}) {
+        MapSettings settings;
+        settings.layout = layout;
+        const World layout_world {context.width, context.height, context.country_count, settings};
+        const Map &map = layout_world.map;
+
+        TileStampSet visited;
+        std::vector<TileIndex> queue;
+        auto flood_result = benchmark::run("layout_flood_fill", context.repetitions, 1, [&] {
+            visited.reset(map.get_tile_index_count());
+            visited.next_generation();
+            queue.clear();
+        }, [&] {
+            // every tile of country 1 starts a fill if no earlier fill reached it
+            for (TileIndex start : layout_world.territory.get_tiles(1)) {
+                if (!visited.mark(start))
+                    continue;
+                size_t i = queue.size();
+                queue.push_back(start);
+                for (; i < queue.size(); i++) {
+                    auto neighbors = map.get_tile_neighbors(queue[i]);
+                    for (unsigned land = map.get_land_neighbors(queue[i]); land != 0; land &= land - 1) {
+                        TileIndex neighbor = neighbors[__builtin_ctz(land)];
+                        if (map.get_owner(neighbor) == 1 && visited.mark(neighbor))
+                            queue.push_back(neighbor);
+                    }
+                }
+            }
+        });
+        flood_result.operations_per_run = std::max<size_t>(queue.size(), 1);
+        flood_result.parameters["morton"] = layout == TileLayout::Morton;
+        flood_result.parameters["tiles_filled"] = queue.size();
+        context.results.push_back(flood_result);
+
+        World attack_world = layout_world;
+        Attack attack {1, 2, 0};
+        TileStampSet stamps;
+        std::vector<TileIndex> tiles_changed;
+        auto attack_result = benchmark::run("layout_attack_advance", context.repetitions, 1, [&] {
+            attack_world = layout_world;
+            attack = Attack {1, 2, attack_world.countries.at(1).get_troops()};
+            stamps.reset(map.get_tile_index_count());
+            tiles_changed.clear();
+        }, [&] {
+            while (attack_world.advance(attack, stamps, tiles_changed)) {}
+        });
+        attack_result.operations_per_run = std::max<size_t>(tiles_changed.size(), 1);
+        attack_result.parameters["morton"] = layout == TileLayout::Morton;
+        attack_result.parameters["tiles_captured"] = tiles_changed.size();
+        context.results.push_back(attack_result);
+    }
+    return true;
+}
+
+static bool benchmark_population(Context &context) {
+    constexpr unsigned pyramid_ticks = 10'000;
+    PopulationPyramid pyramid;
+    context.results.push_back(benchmark::run("population_pyramid_tick", context.repetitions, pyramid_ticks, [&] {
+        pyramid = PopulationPyramid {};
+    }, [&] {
+        for (unsigned i = 0; i < pyramid_ticks; i++)
+            pyramid.tick(100, 1'000, 1);
+    }));
+
+    constexpr unsigned economy_calls = 100'000;
+    std::vector<PyramidUtils::EconomyHistory> economy_histories(context.country_count);
+    context.results.push_back(benchmark::run("get_economy_score", context.repetitions, economy_calls, [&] {
+        unsigned long long score = 0;
+        for (unsigned i = 0; i < economy_calls; i++)
+            score += PyramidUtils::get_economy_score(pyramid, economy_histories[i % context.country_count], 10).score;
+        if (score == 0)
+            std::cerr << "get_economy_score: no score\n";
+    }));
+    return true;
+}
+
+// every benchmark of the suite, run in this order
+// new benchmarks are added here
+static const Benchmark benchmarks[] {
+    {"map_generation", benchmark_map_generation},
+    {"elevation", benchmark_elevation},
+    {"owner_scan", benchmark_owner_scan},
+    {"count_owned_tiles", benchmark_count_owned_tiles},
+    {"tile_strides", benchmark_tile_strides},
+    {"get_border", benchmark_get_border},
+    {"border_sweep", benchmark_border_sweep},
+    {"get_border_with_masks", benchmark_get_border_with_masks},
+    {"can_attack", benchmark_can_attack},
+    {"country_lookup", benchmark_country_lookup},
+    {"attack_advance", benchmark_attack_advance},
+    {"concurrent_attacks", benchmark_concurrent_attacks},
+    {"tile_layouts", benchmark_tile_layouts},
+    {"population", benchmark_population},
+};
+
+int main(int argc, char *argv[]) {
+    unsigned width = benchmark::get_argument(argc, argv, "--width", 1024);
+    unsigned height = benchmark::get_argument(argc, argv, "--height", 1024);
+    unsigned country_count = benchmark::get_argument(argc, argv, "--countries", 64);
+    unsigned repetitions = benchmark::get_argument(argc, argv, "--repetitions", 5);
+    const char *output_path = benchmark::get_string_argument(argc, argv, "--output", nullptr);
+    const char *filter = benchmark::get_string_argument(argc, argv, "--filter", nullptr);
+    if (width == 0 || height == 0 || width > 65'535 || height > 65'535 ||
+            country_count < 2 || country_count > country_id_countCE - 1 || repetitions == 0) {
+        std::cerr << "usage: " << argv[0] << " [--width 1-65535] [--height 1-65535] [--countries 2-255]"
+                  << " [--repetitions >0] [--output file.json] [--filter name]\n";
+        return 1;
+    }
+
+    std::vector<benchmark::Result> results;
+    const World world {width, height, country_count};
+    Context context {width, height, country_count, repetitions, world, results};
+    for (const Benchmark &benchmark : benchmarks) {
+        if (filter != nullptr && std::strstr(benchmark.name, filter) == nullptr)
+            continue;
+        if (!benchmark.function(context))
+            return 1;
+    }
+
+    std::map<std::string, double> parameters {
+        {"width", (double)width},
+        {"height", (double)height},
+        {"countries", (double)country_count},
+        {"repetitions", (double)repetitions},
+    };
+    if (output_path != nullptr) {
+        std::ofstream output {output_path};
+        benchmark::write_json(output, parameters, results);
+    } else
+        benchmark::write_json(std::cout, parameters, results);
+
+    for (const auto &result : results)
+        std::cerr << result.name << ": " << result.median_ms() << " ms (median of " << result.runs_ms.size() << ")\n";
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Compares the TerritoryIndex against the std::map<CountryId, std::set<TileIndex>>
+// that Match used to store the tiles owned by each country.
+//
+// usage: Conqorial-TerritoryBenchmark [tile_count] [country_count] [captures]
+
+#include "RandomGenerator.h"
+#include "TerritoryIndex.h"
+#include "typedefs.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace std::chrono;
+
+struct Capture {
+    TileIndex tile;
+    CountryId new_owner;
+};
+
+struct BenchmarkResult {
+    double fill_ms;
+    double captures_ms;
+    double contains_ms;
+    double iterate_ms;
+    unsigned long long checksum;
+};
+
+template<typename Function>
+double time_ms(Function &&function) {
+    auto start = steady_clock::now();
+    function();
+    return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+BenchmarkResult run_std_set(TileIndex tile_count, unsigned country_count, const std::vector<CountryId> &initial_owners, const std::vector<Capture> &captures) {
+    BenchmarkResult result {};
+    std::map<CountryId, std::set<TileIndex>> tiles_owned_by_country;
+    std::vector<CountryId> owners = initial_owners;
+
+    result.fill_ms = time_ms([&] {
+        for (TileIndex tile = 0; tile < tile_count; tile++)
+            tiles_owned_by_country[owners[tile]].insert(tile);
+    });
+    result.captures_ms = time_ms([&] {
+        for (auto [tile, new_owner] : captures) {
+            if (owners[tile] == new_owner)
+                continue;
+            tiles_owned_by_country[new_owner].insert(tile);
+            tiles_owned_by_country[owners[tile]].erase(tile);
+            owners[tile] = new_owner;
+        }
+    });
+    result.contains_ms = time_ms([&] {
+        for (auto [tile, new_owner] : captures)
+            result.checksum += tiles_owned_by_country[new_owner].count(tile);
+    });
+    result.iterate_ms = time_ms([&] {
+        for (unsigned country = 0; country < country_count; country++) {
+            for (TileIndex tile : tiles_owned_by_country[country])
+                result.checksum += tile;
+        }
+    });
+    return result;
+}
+
+BenchmarkResult run_territory_index(TileIndex tile_count, unsigned country_count, const std::vector<CountryId> &initial_owners, const std::vector<Capture> &captures) {
+    BenchmarkResult result {};
+    TerritoryIndex tiles_owned_by_country;
+    std::vector<CountryId> owners = initial_owners;
+
+    result.fill_ms = time_ms([&] {
+        tiles_owned_by_country.reset(tile_count);
+        for (TileIndex tile = 0; tile < tile_count; tile++)
+            tiles_owned_by_country.insert(owners[tile], tile);
+    });
+    result.captures_ms = time_ms([&] {
+        for (auto [tile, new_owner] : captures) {
+            if (owners[tile] == new_owner)
+                continue;
+            tiles_owned_by_country.erase(owners[tile], tile);
+            tiles_owned_by_country.insert(new_owner, tile);
+            owners[tile] = new_owner;
+        }
+    });
+    result.contains_ms = time_ms([&] {
+        for (auto [tile, new_owner] : captures)
+            result.checksum += tiles_owned_by_country.contains(new_owner, tile);
+    });
+    result.iterate_ms = time_ms([&] {
+        for (unsigned country = 0; country < country_count; country++) {
+            for (TileIndex tile : tiles_owned_by_country.get_tiles(country))
+                result.checksum += tile;
+        }
+    });
+    return result;
+}
+
+void print_result(const char *name, const BenchmarkResult &result) {
+    std::cout << name << ":\n"
+              << "  fill:     " << result.fill_ms << " ms\n"
+              << "  captures: " << result.captures_ms << " ms\n"
+              << "  contains: " << result.contains_ms << " ms\n"
+              << "  iterate:  " << result.iterate_ms << " ms\n"
+              << "  checksum: " << result.checksum << '\n';
+}
+
+int main(int argc, char *argv[]) {
+    TileIndex tile_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 600 * 600;
+    unsigned country_count = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16;
+    unsigned capture_count = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1'000'000;
+    if (tile_count == 0 || country_count == 0 || country_count > country_id_countCE) {
+        std::cerr << "usage: " << argv[0] << " [tile_count] [country_count (1-256)] [captures]\n";
+        return 1;
+    }
+
+    RandomGenerator random {42};
+    std::vector<CountryId> initial_owners(tile_count);
+    for (auto &owner : initial_owners)
+        owner = random.randint(0, country_count - 1);
+
+    std::vector<Capture> captures(capture_count);
+    for (auto &capture : captures) {
+        capture.tile = random.randint(0, tile_count - 1);
+        capture.new_owner = random.randint(0, country_count - 1);
+    }
+
+    std::cout << "tiles: " << tile_count << ", countries: " << country_count << ", captures: " << capture_count << '\n';
+    auto std_set_result = run_std_set(tile_count, country_count, initial_owners, captures);
+    auto territory_index_result = run_territory_index(tile_count, country_count, initial_owners, captures);
+    print_result("std::map<CountryId, std::set<TileIndex>>", std_set_result);
+    print_result("TerritoryIndex", territory_index_result);
+    return 0;
+}
+
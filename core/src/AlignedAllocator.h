@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// An allocator for std::vector that aligns the data to Alignment bytes
+// (eg. to a cache line, so a plane of tiles starts on one and SIMD loads are aligned)
+template<typename T, size_t Alignment>
+struct AlignedAllocator {
+    static_assert(Alignment >= alignof(T), "the alignment must be at least the one of T");
+    typedef T value_type;
+
+    template<typename U>
+    struct rebind {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator() = default;
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(size_t count) {
+        return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t {Alignment}));
+    }
+
+    void deallocate(T *pointer, size_t) {
+        ::operator delete(pointer, std::align_val_t {Alignment});
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
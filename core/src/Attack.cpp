@@ -5,18 +5,18 @@
 #include <cmath>
 #include <optional>
 
-std::set<std::pair<TileCoor, TileCoor>> Attack::advance(
-        Map &map,
-        std::map<CountryId, Country> &countries,
-        std::map<CountryId, std::set<TileIndex>> &tiles_owned_by_country
+bool Attack::advance(
+        const Map &map,
+        CountryTable &countries,
+        TileStampSet &stamps
 ) {
     double troop_cost_per_pixel = 100.0;
 
     const Country *defender {nullptr};
     if (this->defender != 0)
-        defender = &countries.at(this->defender);
+        defender = &countries[this->defender];
 
-    Country &attacker = countries.at(this->attacker);
+    Country &attacker = countries[this->attacker];
 
     double defending_troops = 0.0;
     if (defender != nullptr) {
@@ -37,50 +37,49 @@ std::set<std::pair<TileCoor, TileCoor>> Attack::advance(
     const unsigned pixels_to_capture {static_cast<unsigned int>(this->troops_to_attack / troop_cost_per_pixel)};
 
     // get border between this and other
-    std::set<std::pair<TileCoor, TileCoor>> border;
-    constexpr int directions[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-
-    if (this->current_boder.empty()) {
-        // no cached border, do a full check over the entire map
-        auto border_result = map.get_border(this->attacker, tiles_owned_by_country, this->defender);
-        for (TileIndex tile : border_result.border)
-            border.insert(map.get_tile_coors(tile));
+    next_border.clear();
+    last_advance_seeded = this->current_boder.empty();
+    if (last_advance_seeded) {
+        // no cached border, ask the map for the border between the 2 countries
+        find_frontier_seeds(map, this->attacker, this->defender, next_border);
     } else {
         // just check the cached border
-        for (auto [x, y] : this->current_boder) {
-            for (auto &dir : directions) {
-                int nx = x + dir[0];
-                int ny = y + dir[1];
-                if (nx >= 0 && nx < (int)map.get_width() && ny >= 0 && ny < (int)map.get_height()) {
-                    MapTile neighbor = map.get_tile(nx, ny);
-                    if (neighbor.owner == this->defender && neighbor.type != MapTileType::Water) {
-                        border.insert({nx, ny});
-                    }
-                }
-            }
-        }
+        expand_frontier(map, this->current_boder, this->defender, stamps, next_border);
         CQ_LOG_DEBUG << "Cached border size: " << this->current_boder.size() << '\n';
     }
 
-    CONQORIAL_ASSERT_ALL(!border.empty(), "I thought there was a border but it is empty???", return {};);
+    CONQORIAL_ASSERT_ALL(!next_border.empty(), "I thought there was a border but it is empty???", return false;);
 
-    if (border.size() > pixels_to_capture) {
+    if (next_border.size() > pixels_to_capture) {
         CQ_LOG_RELEASE_ERROR << "Not enough troops" << '\n';
-        return {};
+        return false;
     }
 
-    for (const auto &tile : border) {
-        tiles_owned_by_country[this->attacker].insert(map.get_tile_index(tile));
-        tiles_owned_by_country[this->defender].erase(map.get_tile_index(tile));
-        map.set_tile(tile, attacker.get_id());
+    // every tile is paid for separately, so the rounding is the same as when they were captured one at a time
+    for (size_t i = 0; i < next_border.size(); i++) {
         attacker.troops -= troop_cost_per_pixel;
         this->troops_to_attack -= troop_cost_per_pixel;
     }
 
     // remove casualities from the population pyramid
-    attacker.pyramid.remove_casualties(border.size() * troop_cost_per_pixel);
+    attacker.details->pyramid.remove_casualties(next_border.size() * troop_cost_per_pixel);
+
+    std::swap(this->current_boder, next_border);
+    return true;
+}
 
-    this->current_boder = border;
-    return border;
+
+void Attack::restart(CountryId attacker, CountryId defender, unsigned troops_to_attack) {
+    this->attacker = attacker;
+    this->defender = defender;
+    this->troops_to_attack = troops_to_attack;
+    current_boder.clear();
+    next_border.clear();
+    last_advance_seeded = false;
 }
 
+Span<const TileIndex> Attack::get_captured_tiles() const {
+    if (last_advance_seeded)
+        return {};
+    return {current_boder.data(), current_boder.size()};
+}
@@ -1,25 +1,42 @@
 #ifndef ATTACK_H
 #define ATTACK_H
 
-#include "Country.h"
+#include "CountryTable.h"
+#include "Frontier.h"
+#include "Span.h"
 #include "typedefs.h"
-#include <set>
-#include <map>
+#include <vector>
 
 struct Attack {
     CountryId attacker;
     CountryId defender;
     unsigned troops_to_attack;
-    std::set<std::pair<TileCoor, TileCoor>> current_boder;
+    // the tiles captured by the last advance, the next ones to capture are next to them
+    std::vector<TileIndex> current_boder;
+    // where the next border is built, it is swapped with current_boder so both buffers are reused
+    std::vector<TileIndex> next_border;
+    // true if the last advance started the attack from the attacker's side of the border,
+    // the tiles in current_boder then already belonged to the attacker
+    bool last_advance_seeded = false;
 
     Attack(CountryId attacker, CountryId defender, unsigned troops_to_attack) :
         attacker {attacker},
         defender {defender},
         troops_to_attack {troops_to_attack},
-        current_boder {}
+        current_boder {},
+        next_border {}
     {}
 
-    std::set<std::pair<TileCoor, TileCoor>> advance(Map &map, std::map<CountryId, Country> &countries, std::map<CountryId, std::set<TileIndex>> &tiles_owned_by_country);
+    // makes this a new attack, the border buffers keep their memory
+    void restart(CountryId attacker, CountryId defender, unsigned troops_to_attack);
+
+    // captures the next layer of tiles and pays for them
+    // the map is not changed, the caller has to give get_captured_tiles() to the attacker
+    // (Match::transfer_tiles) before the next advance
+    // returns false when the attack is over
+    bool advance(const Map &map, CountryTable &countries, TileStampSet &stamps);
+    // the tiles of the defender the last advance captured
+    Span<const TileIndex> get_captured_tiles() const;
 };
 
 #endif
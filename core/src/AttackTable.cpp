@@ -0,0 +1,74 @@
+#include "AttackTable.h"
+#include "Logging.h"
+#include <algorithm>
+
+AttackTable::AttackTable() : pair_slots(country_id_countCE * country_id_countCE, 0) {}
+
+uint64_t AttackTable::get_order(uint32_t slot) const {
+    const Attack &attack = slots[slot].attack;
+    return get_pair(attack.attacker, attack.defender);
+}
+
+void AttackTable::release(uint32_t slot) {
+    Slot &released = slots[slot];
+    pair_slots[get_pair(released.attack.attacker, released.attack.defender)] = 0;
+    released.generation++;
+    released.in_use = false;
+    free_slots.push_back(slot);
+}
+
+AttackHandle AttackTable::start(CountryId attacker, CountryId defender, unsigned troops_to_attack) {
+    CONQORIAL_ASSERT_ALL(attacker != defender, "A country can not attack itself",
+            std::cerr << "Country id: " << (short)attacker << '\n'; return {};);
+    CONQORIAL_ASSERT_ALL(pair_slots[get_pair(attacker, defender)] == 0, "The attacker is already attacking the defender",
+            return find(attacker, defender););
+
+    uint32_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+        slots[slot].attack.restart(attacker, defender, troops_to_attack);
+    } else {
+        slot = slots.size();
+        slots.push_back({Attack {attacker, defender, troops_to_attack}, 0, false});
+    }
+    slots[slot].in_use = true;
+    pair_slots[get_pair(attacker, defender)] = slot + 1;
+
+    uint64_t order = get_pair(attacker, defender);
+    auto position = std::lower_bound(active.begin(), active.end(), order, [this](uint32_t active_slot, uint64_t order) {
+        return get_order(active_slot) < order;
+    });
+    active.insert(position, slot);
+    return {slot, slots[slot].generation};
+}
+
+AttackHandle AttackTable::find(CountryId attacker, CountryId defender) const {
+    uint16_t slot = pair_slots[get_pair(attacker, defender)];
+    if (slot == 0)
+        return {};
+    return {slot - 1u, slots[slot - 1].generation};
+}
+
+bool AttackTable::is_current(AttackHandle handle) const {
+    return handle.slot < slots.size() && slots[handle.slot].in_use && slots[handle.slot].generation == handle.generation;
+}
+
+Attack *AttackTable::get(AttackHandle handle) {
+    return is_current(handle) ? &slots[handle.slot].attack : nullptr;
+}
+
+const Attack *AttackTable::get(AttackHandle handle) const {
+    return is_current(handle) ? &slots[handle.slot].attack : nullptr;
+}
+
+void AttackTable::end(AttackHandle handle) {
+    if (!is_current(handle))
+        return;
+    active.erase(std::find(active.begin(), active.end(), handle.slot));
+    release(handle.slot);
+}
+
+size_t AttackTable::size() const {
+    return active.size();
+}
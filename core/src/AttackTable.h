@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Attack.h"
+#include "typedefs.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// refers to an attack in an AttackTable, it stops working when the attack ends
+// (even if the slot is reused for another attack)
+struct AttackHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Every ongoing attack of a match.
+// The attacks live in slots that are reused when an attack ends, so their border
+// buffers keep their memory for the next attack. Handles check the generation of
+// their slot, so a handle to an attack that ended finds nothing.
+// Finding the attack of an attacker on a defender is a single read in a dense
+// country_id_countCE x country_id_countCE index.
+class AttackTable {
+    struct Slot {
+        Attack attack {0, 0, 0};
+        // goes up every time the attack in the slot ends
+        uint32_t generation = 0;
+        bool in_use = false;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free_slots;
+    // the slots of the ongoing attacks sorted by attacker then defender,
+    // which is the order they advance in no matter which slots they got
+    std::vector<uint32_t> active;
+    // attacker * country_id_countCE + defender -> slot + 1, 0 if there is no attack
+    // start refuses attacks on the attacker itself, so there are at most
+    // country_id_countCE * (country_id_countCE - 1) = 65280 attacks and slot + 1 always fits
+    std::vector<uint16_t> pair_slots;
+    static_assert(country_id_countCE * (country_id_countCE - 1) <= UINT16_MAX,
+                  "the slots of all the attacks must fit in pair_slots");
+
+    static size_t get_pair(CountryId attacker, CountryId defender) {
+        return attacker * country_id_countCE + defender;
+    }
+    uint64_t get_order(uint32_t slot) const;
+    bool is_current(AttackHandle handle) const;
+    void release(uint32_t slot);
+
+public:
+    AttackTable();
+
+    // the attacker must not be attacking the defender already and must not be the defender
+    // returns an invalid handle if it is the defender
+    AttackHandle start(CountryId attacker, CountryId defender, unsigned troops_to_attack);
+    // an invalid handle if the attacker is not attacking the defender
+    AttackHandle find(CountryId attacker, CountryId defender) const;
+    // nullptr if the attack of the handle is over
+    Attack *get(AttackHandle handle);
+    const Attack *get(AttackHandle handle) const;
+    // does nothing if the attack of the handle is already over
+    void end(AttackHandle handle);
+
+    size_t size() const;
+
+    // calls function with every ongoing attack in order and ends the ones it returns false for
+    // function must not start or end attacks
+    template<typename Function>
+    void update(Function &&function) {
+        size_t kept = 0;
+        for (size_t i = 0; i < active.size(); i++) {
+            uint32_t slot = active[i];
+            if (function(slots[slot].attack))
+                active[kept++] = slot;
+            else
+                release(slot);
+        }
+        active.resize(kept);
+    }
+};
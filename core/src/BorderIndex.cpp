@@ -0,0 +1,68 @@
+#include "BorderIndex.h"
+#include "Logging.h"
+
+void BorderIndex::reset(TileIndex tile_count) {
+    foreign_neighbors.assign(tile_count, 0);
+    border_tiles.reset(tile_count);
+    shared_edges.assign(country_id_countCE * country_id_countCE, 0);
+}
+
+void BorderIndex::rebuild(TileIndex tile_count, const BorderSweep &sweep) {
+    reset(tile_count);
+    // every edge has a pair on both sides, so each side only counts its own direction
+    for (unsigned country = 0; country < country_id_countCE; country++) {
+        for (BorderPair pair : sweep.get_pairs(country)) {
+            foreign_neighbors[pair.tile]++;
+            shared_edges[country * country_id_countCE + pair.neighbor]++;
+            border_tiles.insert(country, pair.tile);
+        }
+    }
+}
+
+void BorderIndex::add_shared_edge(CountryId a, CountryId b) {
+    shared_edges[a * country_id_countCE + b]++;
+    shared_edges[b * country_id_countCE + a]++;
+}
+
+void BorderIndex::remove_shared_edge(CountryId a, CountryId b) {
+    unsigned &a_to_b = shared_edges[a * country_id_countCE + b];
+    unsigned &b_to_a = shared_edges[b * country_id_countCE + a];
+    CONQORIAL_ASSERT_ALL(a_to_b != 0 && b_to_a != 0, "Tried to remove a shared edge that does not exist",
+            std::cerr << "Countries: " << (short)a << ", " << (short)b << '\n'; return;);
+
+    a_to_b--;
+    b_to_a--;
+}
+
+void BorderIndex::change_foreign_neighbors(TileIndex tile, CountryId owner, int delta) {
+    uint8_t &count = foreign_neighbors[tile];
+    CONQORIAL_DEBUG_ASSERT(count + delta >= 0 && count + delta <= 4, std::string("Foreign neighbor count out of range"));
+
+    count += delta;
+    if (count == 0)
+        border_tiles.erase(owner, tile);
+    else if (count == 1 && delta > 0)
+        border_tiles.insert(owner, tile);
+}
+
+void BorderIndex::move_tile(TileIndex tile, CountryId old_owner, CountryId new_owner, uint8_t foreign_neighbor_count) {
+    if (foreign_neighbors[tile] != 0)
+        border_tiles.erase(old_owner, tile);
+
+    foreign_neighbors[tile] = foreign_neighbor_count;
+    if (foreign_neighbor_count != 0)
+        border_tiles.insert(new_owner, tile);
+}
+
+uint8_t BorderIndex::get_foreign_neighbors(TileIndex tile) const {
+    return foreign_neighbors[tile];
+}
+
+const std::vector<TileIndex> &BorderIndex::get_border_tiles(CountryId country) const {
+    return border_tiles.get_tiles(country);
+}
+
+unsigned BorderIndex::get_shared_edges(CountryId a, CountryId b) const {
+    return shared_edges[a * country_id_countCE + b];
+}
+
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "BorderSweep.h"
+#include "TerritoryIndex.h"
+#include "typedefs.h"
+#include <cstdint>
+#include <vector>
+
+// Keeps track of which land tiles are on the border of each country
+// and which countries border each other.
+// It is updated by the Map every time a tile changes owner,
+// so border queries never have to walk over a whole territory.
+class BorderIndex {
+    // number of land neighbors of each tile that are owned by a different country
+    std::vector<uint8_t> foreign_neighbors;
+    // the land tiles of each country that have at least one foreign land neighbor
+    TerritoryIndex border_tiles;
+    // the number of land tile edges shared by 2 countries
+    // it is a country_id_countCE x country_id_countCE table indexed by
+    // a * country_id_countCE + b so checking if 2 countries border is a single read
+    std::vector<unsigned> shared_edges;
+
+public:
+    BorderIndex() = default;
+
+    // removes everything and makes room for tile_count tiles
+    void reset(TileIndex tile_count);
+    // builds everything again from the border pairs of all countries
+    void rebuild(TileIndex tile_count, const BorderSweep &sweep);
+
+    // called when 2 land tiles owned by a and b become/stop being neighbors
+    void add_shared_edge(CountryId a, CountryId b);
+    void remove_shared_edge(CountryId a, CountryId b);
+
+    // called when a neighbor of the tile changed owner
+    // delta is +1 if the neighbor is now foreign and -1 if it is not foreign anymore
+    void change_foreign_neighbors(TileIndex tile, CountryId owner, int delta);
+    // called when the tile itself changes owner
+    void move_tile(TileIndex tile, CountryId old_owner, CountryId new_owner, uint8_t foreign_neighbor_count);
+
+    uint8_t get_foreign_neighbors(TileIndex tile) const;
+    const std::vector<TileIndex> &get_border_tiles(CountryId country) const;
+    unsigned get_shared_edges(CountryId a, CountryId b) const;
+    // appends every country that shares at least one edge with the country to out
+    template<typename OutputIt>
+    void get_neighbors(CountryId country, OutputIt out) const {
+        const unsigned *row = &shared_edges[country * country_id_countCE];
+        for (unsigned other = 0; other < country_id_countCE; other++) {
+            if (row[other] != 0)
+                *out++ = static_cast<CountryId>(other);
+        }
+    }
+};
+
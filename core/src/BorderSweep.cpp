@@ -0,0 +1,101 @@
+#include "BorderSweep.h"
+#include "Map.h"
+#include "MapTileTypes.h"
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// a copy of one row, the rows of the Morton layout are gathered into a shared buffer
+// and 2 rows are needed at the same time
+struct SweepRow {
+    std::vector<CountryId> owners;
+    std::vector<MapTileType> types;
+
+    void load(const Map &map, unsigned y) {
+        auto owner_row = map.get_owner_row(y);
+        owners.assign(owner_row.begin(), owner_row.end());
+        auto type_row = map.get_type_row(y);
+        types.assign(type_row.begin(), type_row.end());
+    }
+
+    bool is_land(unsigned x) const {
+        return types[x] != MapTileType::Water;
+    }
+};
+
+constexpr unsigned sweep_blockCE = 16;
+
+// bit i is set if the tiles x + i of a and x + i + offset of b are land owned by different countries
+unsigned get_border_bits(const SweepRow &a, const SweepRow &b, unsigned x, unsigned offset) {
+#ifdef __SSE2__
+    auto load = [](const void *pointer) { return _mm_loadu_si128(static_cast<const __m128i *>(pointer)); };
+    const __m128i water = _mm_set1_epi8(static_cast<char>(MapTileType::Water));
+    __m128i same_owner = _mm_cmpeq_epi8(load(a.owners.data() + x), load(b.owners.data() + x + offset));
+    __m128i any_water = _mm_or_si128(_mm_cmpeq_epi8(load(a.types.data() + x), water),
+                                     _mm_cmpeq_epi8(load(b.types.data() + x + offset), water));
+    return ~static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(same_owner, any_water))) & 0xffff;
+#else
+    unsigned bits = 0;
+    for (unsigned i = 0; i < sweep_blockCE; i++) {
+        bool border = a.is_land(x + i) && b.is_land(x + i + offset) && a.owners[x + i] != b.owners[x + i + offset];
+        bits |= (unsigned)border << i;
+    }
+    return bits;
+#endif
+}
+
+} // namespace
+
+void BorderSweep::sweep(const Map &map) {
+    for (auto &country_pairs : pairs)
+        country_pairs.clear();
+
+    unsigned width = map.get_width(), height = map.get_height();
+    SweepRow row, next_row;
+    row.load(map, 0);
+
+    // every edge is found once, from the tile on its left or top
+    auto add_edge = [this, &map](unsigned x, unsigned y, CountryId owner, unsigned other_x, unsigned other_y, CountryId other_owner) {
+        pairs[owner].push_back({map.get_tile_index(x, y), other_owner});
+        pairs[other_owner].push_back({map.get_tile_index(other_x, other_y), owner});
+    };
+
+    for (unsigned y = 0; y < height; y++) {
+        bool has_next_row = y + 1 < height;
+        if (has_next_row)
+            next_row.load(map, y + 1);
+
+        unsigned x = 0;
+        // the right neighbor of the last tile of a block is read too, so the last tile of the row is left for the loop below
+        for (; x + sweep_blockCE < width; x += sweep_blockCE) {
+            for (unsigned bits = get_border_bits(row, row, x, 1); bits != 0; bits &= bits - 1) {
+                unsigned tile_x = x + __builtin_ctz(bits);
+                add_edge(tile_x, y, row.owners[tile_x], tile_x + 1, y, row.owners[tile_x + 1]);
+            }
+            if (!has_next_row)
+                continue;
+            for (unsigned bits = get_border_bits(row, next_row, x, 0); bits != 0; bits &= bits - 1) {
+                unsigned tile_x = x + __builtin_ctz(bits);
+                add_edge(tile_x, y, row.owners[tile_x], tile_x, y + 1, next_row.owners[tile_x]);
+            }
+        }
+        for (; x < width; x++) {
+            if (!row.is_land(x))
+                continue;
+            if (x + 1 < width && row.is_land(x + 1) && row.owners[x] != row.owners[x + 1])
+                add_edge(x, y, row.owners[x], x + 1, y, row.owners[x + 1]);
+            if (has_next_row && next_row.is_land(x) && row.owners[x] != next_row.owners[x])
+                add_edge(x, y, row.owners[x], x, y + 1, next_row.owners[x]);
+        }
+
+        std::swap(row, next_row);
+    }
+}
+
+const std::vector<BorderPair> &BorderSweep::get_pairs(CountryId country) const {
+    return pairs[country];
+}
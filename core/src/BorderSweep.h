@@ -0,0 +1,30 @@
+#pragma once
+
+#include "typedefs.h"
+#include <array>
+#include <vector>
+
+class Map;
+
+// a land tile and the owner of one of its land neighbors, which is not the owner of the tile
+struct BorderPair {
+    TileIndex tile;
+    CountryId neighbor;
+};
+
+// Finds the borders of every country (including 0) with one pass over the map.
+// Each row is compared with the next tile and the next row 16 tiles at a time,
+// so the rows inside of territories cost a few compares per 16 tiles.
+// A tile with several foreign neighbors has one pair for each of them.
+class BorderSweep {
+    std::array<std::vector<BorderPair>, country_id_countCE> pairs;
+
+public:
+    BorderSweep() = default;
+
+    // forgets the pairs of the last sweep (but keeps the memory) and finds them again
+    void sweep(const Map &map);
+
+    // the pairs of the country's tiles, in no particular order
+    const std::vector<BorderPair> &get_pairs(CountryId country) const;
+};
@@ -0,0 +1,119 @@
+#include "ChunkIndex.h"
+#include "Logging.h"
+#include <algorithm>
+
+unsigned TileArea::get_tile_count() const {
+    return is_empty() ? 0 : (x_end - x_begin) * (y_end - y_begin);
+}
+
+TileArea TileArea::intersect(const TileArea &other) const {
+    return { std::max(x_begin, other.x_begin), std::max(y_begin, other.y_begin),
+             std::min(x_end, other.x_end), std::min(y_end, other.y_end) };
+}
+
+bool TileArea::is_empty() const {
+    return x_begin >= x_end || y_begin >= y_end;
+}
+
+void ChunkIndex::reset(unsigned width, unsigned height, unsigned chunk_size) {
+    this->width = width;
+    this->height = height;
+    this->chunk_size = chunk_size;
+    owner_counts.clear();
+    dirty.clear();
+    if (chunk_size == 0) {
+        chunks_x = chunks_y = 0;
+        return;
+    }
+
+    chunk_shift = 0;
+    while ((1u << chunk_shift) < chunk_size)
+        chunk_shift++;
+    chunks_x = (width + chunk_size - 1) / chunk_size;
+    chunks_y = (height + chunk_size - 1) / chunk_size;
+    owner_counts.resize(chunks_x * chunks_y);
+    for (unsigned chunk = 0; chunk < owner_counts.size(); chunk++)
+        owner_counts[chunk].push_back({0, get_chunk_area(chunk).get_tile_count()});
+    dirty.assign((owner_counts.size() + 63) / 64, 0);
+}
+
+bool ChunkIndex::is_enabled() const {
+    return chunk_size != 0;
+}
+
+unsigned ChunkIndex::get_chunk_size() const {
+    return chunk_size;
+}
+
+unsigned ChunkIndex::get_chunk_count() const {
+    return chunks_x * chunks_y;
+}
+
+unsigned ChunkIndex::get_chunk(unsigned x, unsigned y) const {
+    return (y >> chunk_shift) * chunks_x + (x >> chunk_shift);
+}
+
+TileArea ChunkIndex::get_chunk_area(unsigned chunk) const {
+    unsigned x = (chunk % chunks_x) * chunk_size;
+    unsigned y = (chunk / chunks_x) * chunk_size;
+    return { x, y, std::min(x + chunk_size, width), std::min(y + chunk_size, height) };
+}
+
+void ChunkIndex::move_tile(unsigned x, unsigned y, CountryId old_owner, CountryId new_owner) {
+    unsigned chunk = get_chunk(x, y);
+    auto &counts = owner_counts[chunk];
+
+    auto old_count = std::find_if(counts.begin(), counts.end(), [old_owner](const OwnerCount &count) {
+        return count.owner == old_owner;
+    });
+    CONQORIAL_ASSERT_ALL(old_count != counts.end(), "The old owner of the tile has no tiles in its chunk",
+            std::cerr << "Owner: " << (short)old_owner << ", chunk: " << chunk << '\n';);
+    if (--old_count->count == 0) {
+        *old_count = counts.back();
+        counts.pop_back();
+    }
+
+    auto new_count = std::find_if(counts.begin(), counts.end(), [new_owner](const OwnerCount &count) {
+        return count.owner == new_owner;
+    });
+    if (new_count == counts.end())
+        counts.push_back({new_owner, 1});
+    else
+        new_count->count++;
+
+    dirty[chunk / 64] |= uint64_t(1) << (chunk % 64);
+}
+
+unsigned ChunkIndex::get_owner_count(unsigned chunk, CountryId owner) const {
+    for (const auto &count : owner_counts[chunk]) {
+        if (count.owner == owner)
+            return count.count;
+    }
+    return 0;
+}
+
+const std::vector<ChunkIndex::OwnerCount> &ChunkIndex::get_owner_counts(unsigned chunk) const {
+    return owner_counts[chunk];
+}
+
+std::optional<CountryId> ChunkIndex::get_single_owner(unsigned chunk) const {
+    if (owner_counts[chunk].size() != 1)
+        return std::nullopt;
+    return owner_counts[chunk].front().owner;
+}
+
+bool ChunkIndex::is_dirty(unsigned chunk) const {
+    return (dirty[chunk / 64] >> (chunk % 64)) & 1;
+}
+
+void ChunkIndex::take_dirty_chunks(std::vector<unsigned> &out) {
+    for (unsigned word = 0; word < dirty.size(); word++) {
+        uint64_t bits = dirty[word];
+        while (bits != 0) {
+            unsigned bit = __builtin_ctzll(bits);
+            out.push_back(word * 64 + bit);
+            bits &= bits - 1;
+        }
+        dirty[word] = 0;
+    }
+}
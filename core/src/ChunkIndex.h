@@ -0,0 +1,71 @@
+#pragma once
+
+#include "typedefs.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// the tiles [x_begin, x_end) x [y_begin, y_end)
+struct TileArea {
+    unsigned x_begin;
+    unsigned y_begin;
+    unsigned x_end;
+    unsigned y_end;
+
+    unsigned get_tile_count() const;
+    // the part of this area that is also in other (empty if they do not overlap)
+    TileArea intersect(const TileArea &other) const;
+    bool is_empty() const;
+};
+
+// Splits the map into square chunks and remembers, for every chunk,
+// how many tiles each owner has in it and whether it changed.
+// Area queries can then skip the chunks a country has nothing in
+// (or owns completely) without reading their tiles.
+// It is updated by the Map every time a tile changes owner.
+class ChunkIndex {
+public:
+    struct OwnerCount {
+        CountryId owner;
+        unsigned count;
+    };
+
+private:
+    unsigned width = 0;
+    unsigned height = 0;
+    unsigned chunk_size = 0;
+    // chunk_size is a power of two, so finding the chunk of a tile is a shift
+    unsigned chunk_shift = 0;
+    unsigned chunks_x = 0;
+    unsigned chunks_y = 0;
+    // the owners with at least one tile in each chunk, there are only a few per chunk
+    std::vector<std::vector<OwnerCount>> owner_counts;
+    // one bit per chunk, set when a tile of the chunk changes owner
+    std::vector<uint64_t> dirty;
+
+public:
+    ChunkIndex() = default;
+
+    // makes chunk_size x chunk_size chunks where every tile is owned by 0
+    // chunk_size must be a power of two, 0 disables the index
+    void reset(unsigned width, unsigned height, unsigned chunk_size);
+    bool is_enabled() const;
+
+    unsigned get_chunk_size() const;
+    unsigned get_chunk_count() const;
+    unsigned get_chunk(unsigned x, unsigned y) const;
+    // the chunks on the edges of the map can be smaller
+    TileArea get_chunk_area(unsigned chunk) const;
+
+    // called when the tile at x, y changes owner
+    void move_tile(unsigned x, unsigned y, CountryId old_owner, CountryId new_owner);
+
+    unsigned get_owner_count(unsigned chunk, CountryId owner) const;
+    const std::vector<OwnerCount> &get_owner_counts(unsigned chunk) const;
+    // the owner of every tile in the chunk, if they all have the same one
+    std::optional<CountryId> get_single_owner(unsigned chunk) const;
+
+    bool is_dirty(unsigned chunk) const;
+    // appends the chunks that changed since the last call to out and marks them as clean
+    void take_dirty_chunks(std::vector<unsigned> &out);
+};
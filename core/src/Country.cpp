@@ -2,7 +2,6 @@
 #include "MapTile.h"
 #include "Logging.h"
 #include "PopulationPyramid.h"
-#include <chrono>
 #include <optional>
 
 AIPlayerBehavior::AIPlayerBehavior(RandomGenerator &random) {
@@ -10,43 +9,38 @@ AIPlayerBehavior::AIPlayerBehavior(RandomGenerator &random) {
     target_mobilization_level = random.randint(ai_mobilization_level_minCE, ai_mobilization_level_maxCE);
     reserve_troops = random.randint(ai_reserve_troops_minCE, ai_reserve_troops_maxCE);
 
-    update_last_attack_check();
+    // countries are created before the simulation starts
+    update_last_attack_check(0);
 }
 
-void AIPlayerBehavior::update_last_attack_check() {
-    last_descision_check = std::chrono::steady_clock::now();
-    auto duration = last_descision_check.time_since_epoch();
-    CQ_LOG_DEBUG << "Last attack check: " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << '\n';
+void AIPlayerBehavior::update_last_attack_check(SimulationTick now) {
+    last_descision_check = now;
+    CQ_LOG_DEBUG << "Last attack check: tick " << now << '\n';
 }
 
 Country::Country(CountryId id, std::string name, Color color, RandomGenerator *random)
-    : id {id}, name {name}, is_human {random == nullptr}, color {color} {
+    : id {id}, is_human {random == nullptr}, color {color},
+      details {std::make_unique<CountryDetails>(CountryDetails {std::move(name), PopulationPyramid {}, {}, std::nullopt})} {
     if (random != nullptr)
-        ai_behavior = AIPlayerBehavior(*random);
-    else
-        ai_behavior = std::nullopt;
+        details->ai_behavior = AIPlayerBehavior(*random);
+}
+
+Country::Country(const Country &other)
+    : id {other.id}, is_human {other.is_human}, target_mobilization_level {other.target_mobilization_level},
+      color {other.color}, troops {other.troops}, millitary_level {other.millitary_level},
+      urbanization_level {other.urbanization_level}, money {other.money},
+      last_economy {other.last_economy}, last_density {other.last_density},
+      details {std::make_unique<CountryDetails>(*other.details)} {}
+
+Country &Country::operator=(const Country &other) {
+    if (this != &other)
+        *this = Country {other};
+    return *this;
 }
 
 bool Country::can_attack(CountryId other_id, const Map &map) const {
     // check if there is a border between the 2 countries
-    int directions[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-    for (unsigned y = 0; y < map.get_height(); y++) {
-        for (unsigned x = 0; x < map.get_width(); x++) {
-            if (map.get_tile(x, y).owner == other_id && map.get_tile(x, y).type != MapTileType::Water) {
-                for (auto &dir : directions) {
-                    int nx = x + dir[0];
-                    int ny = y + dir[1];
-                    if (nx >= 0 && nx < map.get_width() && ny >= 0 && ny < map.get_height()) {
-                        MapTile neighbor = map.get_tile(nx, ny);
-                        if (neighbor.owner == this->id) {
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return false;
+    return map.shares_border(this->id, other_id);
 }
 
 unsigned Country::get_troops() const {
@@ -56,7 +50,7 @@ unsigned Country::get_troops() const {
 void Country::calculate_troops() {
     troops = 0;
     double target_mobilization_level_percent {target_mobilization_level / 100.0};
-    for (const auto piece : pyramid.get_pieces()) {
+    for (const auto piece : details->pyramid.get_pieces()) {
         if (piece.age >= reproductive_age_min && piece.age <= reproductive_age_max)
             troops += (piece.male_count + piece.female_count) * target_mobilization_level_percent;
         if (piece.age > reproductive_age_max)
@@ -69,7 +63,7 @@ unsigned long Country::get_military_score() const {
 }
 
 std::string Country::get_name() const {
-    return name;
+    return details->name;
 }
 
 bool Country::get_is_human() const {
@@ -85,7 +79,7 @@ CountryId Country::get_id() const {
 }
 
 const PopulationPyramid &Country::get_pyramid() const {
-    return pyramid;
+    return details->pyramid;
 }
 
 unsigned Country::get_economy() const {
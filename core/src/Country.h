@@ -7,6 +7,7 @@
 #include "PopulationPyramid.h"
 #include "typedefs.h"
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <optional>
 
@@ -28,10 +29,19 @@ struct AIPlayerBehavior {
     // how troops the AI will ALWAYS keep in reserve as a percentage
     uint8_t reserve_troops;
 
-    CQIntervalTimePoint last_descision_check;
+    SimulationTick last_descision_check;
 
     AIPlayerBehavior(RandomGenerator &random);
-    void update_last_attack_check();
+    void update_last_attack_check(SimulationTick now);
+};
+
+// the parts of a country that are not read every tick
+struct CountryDetails {
+    std::string name;
+    PopulationPyramid pyramid;
+    PyramidUtils::EconomyHistory economy_history;
+    // if .has_value() returns true then it is an AI player
+    std::optional<AIPlayerBehavior> ai_behavior;
 };
 
 class Country {
@@ -39,31 +49,33 @@ class Country {
     friend class PopulationPyramidRenderer;
     friend class Match;
 
+    // the fields read by the simulation loops come first and stay inline,
+    // so a CountryTable of them is small and contiguous
     CountryId id;
-    std::string name;
-
     // false if it is an AI
     bool is_human;
-    Color color;
-
-    unsigned troops = 0;
     // this is a percentage of the reproductive age
     // group (of the pyramid) the player/ai wants to mobilize
     uint8_t target_mobilization_level = 2;
+    Color color;
 
-    unsigned urbanization_level = 1;
+    unsigned troops = 0;
     unsigned millitary_level = 1;
-    PopulationPyramid pyramid;
+    unsigned urbanization_level = 1;
     unsigned money = 0;
     unsigned last_economy = 0;
     unsigned last_density = 0;
 
-    // if .has_value() returns true then it is an AI player
-    std::optional<AIPlayerBehavior> ai_behavior;
+    std::unique_ptr<CountryDetails> details;
 public:
     // if the random generator is passed in then the country will be an AI
     // otherwise it will be a player
     Country(CountryId id, std::string name, Color color, RandomGenerator *random = nullptr);
+    // copies get their own details
+    Country(const Country &other);
+    Country &operator=(const Country &other);
+    Country(Country &&other) = default;
+    Country &operator=(Country &&other) = default;
 
     bool can_attack(CountryId other_id, const Map &map) const;
 
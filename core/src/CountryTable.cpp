@@ -0,0 +1,18 @@
+#include "CountryTable.h"
+
+CountryTable::CountryTable() {
+    countries.reserve(country_id_countCE);
+}
+
+Country &CountryTable::add(Country country) {
+    CONQORIAL_ASSERT_ALL(countries.size() < country_id_countCE, "There are no country ids left",
+            return countries.back(););
+    CONQORIAL_ASSERT_ALL(country.get_id() == countries.size(), "A country was added with an id that is not the next one",
+            std::cerr << "Id: " << (short)country.get_id() << ", expected: " << countries.size() << '\n';);
+    countries.push_back(std::move(country));
+    return countries.back();
+}
+
+CountryId CountryTable::get_next_id() const {
+    return countries.size();
+}
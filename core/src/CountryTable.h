@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Country.h"
+#include "Logging.h"
+#include "typedefs.h"
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// The countries of a match, indexed by their id.
+// Ids are given out in order starting at 0, so the countries are packed in one
+// vector and finding one is an index instead of a tree walk. Room for every id
+// is reserved up front, so references to a country stay valid like with a std::map.
+class CountryTable {
+    std::vector<Country> countries;
+
+public:
+    typedef std::vector<Country>::iterator iterator;
+    typedef std::vector<Country>::const_iterator const_iterator;
+
+    CountryTable();
+
+    // the country must have the id get_next_id() returns
+    Country &add(Country country);
+    CountryId get_next_id() const;
+
+    // throws std::out_of_range if there is no country with the id,
+    // for ids that come from outside the simulation (the player, the network, ...)
+    Country &at(CountryId id) {
+        if (!contains(id))
+            throw std::out_of_range("There is no country with the id " + std::to_string(id));
+        return countries[id];
+    }
+    const Country &at(CountryId id) const {
+        if (!contains(id))
+            throw std::out_of_range("There is no country with the id " + std::to_string(id));
+        return countries[id];
+    }
+    // only checked in debug builds, for the simulation loops whose ids are known to be countries
+    Country &operator[](CountryId id) {
+        CONQORIAL_DEBUG_ASSERT(id < countries.size(), std::string("There is no country with this id"));
+        return countries[id];
+    }
+    const Country &operator[](CountryId id) const {
+        CONQORIAL_DEBUG_ASSERT(id < countries.size(), std::string("There is no country with this id"));
+        return countries[id];
+    }
+    bool contains(CountryId id) const { return id < countries.size(); }
+
+    size_t size() const { return countries.size(); }
+    bool empty() const { return countries.empty(); }
+
+    // in the order of the ids, the neutral country first
+    iterator begin() { return countries.begin(); }
+    iterator end() { return countries.end(); }
+    const_iterator begin() const { return countries.begin(); }
+    const_iterator end() const { return countries.end(); }
+};
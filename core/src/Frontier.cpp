@@ -0,0 +1,60 @@
+#include "Frontier.h"
+#include "OwnershipMask.h"
+#include <algorithm>
+
+void TileStampSet::reset(TileIndex tile_count) {
+    stamps.assign(tile_count, 0);
+    generation = 0;
+}
+
+void TileStampSet::next_generation() {
+    generation++;
+    // after a wrap around old stamps could look like they are from this generation
+    if (generation == 0) {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        generation = 1;
+    }
+}
+
+bool TileStampSet::mark(TileIndex tile) {
+    if (stamps[tile] == generation)
+        return false;
+    stamps[tile] = generation;
+    return true;
+}
+
+void expand_frontier(const Map &map, const std::vector<TileIndex> &frontier, CountryId target,
+                     TileStampSet &stamps, std::vector<TileIndex> &out) {
+    stamps.next_generation();
+    for (TileIndex tile : frontier) {
+        // the water ring around the map means no bounds checks are needed
+        // and the land mask means the water neighbors are never read
+        auto neighbors = map.get_tile_neighbors(tile);
+        for (unsigned land = map.get_land_neighbors(tile); land != 0; land &= land - 1) {
+            TileIndex neighbor_index = neighbors[__builtin_ctz(land)];
+            if (map.get_owner(neighbor_index) == target && stamps.mark(neighbor_index))
+                out.push_back(neighbor_index);
+        }
+    }
+}
+
+void find_frontier_seeds(const Map &map, CountryId from, CountryId to, std::vector<TileIndex> &out) {
+    if (from == to)
+        return;
+    // a border this big is cheaper to find with masks, 64 tiles at a time
+    const std::vector<TileIndex> &border_tiles = map.get_border_tiles(from);
+    if (border_tiles.size() > (size_t)map.get_width() * map.get_height() / mask_border_divisorCE) {
+        BorderMasks masks;
+        find_border_with_masks(map, from, to, masks, out);
+        return;
+    }
+    for (TileIndex tile : border_tiles) {
+        auto neighbors = map.get_tile_neighbors(tile);
+        for (unsigned land = map.get_land_neighbors(tile); land != 0; land &= land - 1) {
+            if (map.get_owner(neighbors[__builtin_ctz(land)]) == to) {
+                out.push_back(tile);
+                break;
+            }
+        }
+    }
+}
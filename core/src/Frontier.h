@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Map.h"
+#include "typedefs.h"
+#include <cstdint>
+#include <vector>
+
+// Marks tiles with a generation number so a set of tiles can be
+// deduplicated without clearing anything between uses.
+// Starting a new generation forgets every marked tile in O(1).
+class TileStampSet {
+    std::vector<uint32_t> stamps;
+    uint32_t generation = 0;
+
+public:
+    TileStampSet() = default;
+
+    // makes room for tile_count tiles and forgets every marked tile
+    void reset(TileIndex tile_count);
+    void next_generation();
+
+    // returns true if the tile was not marked during this generation yet
+    bool mark(TileIndex tile);
+};
+
+// Appends every land tile owned by target that is next to a tile of the frontier to out.
+// Each tile is only appended once, the stamps are moved to a new generation first.
+// This does not allocate once out has grown to the size of the frontier.
+void expand_frontier(const Map &map, const std::vector<TileIndex> &frontier, CountryId target,
+                     TileStampSet &stamps, std::vector<TileIndex> &out);
+
+// Appends the border tiles of from that are next to land owned by to.
+// If the border of from is a big part of the map, the whole map is scanned with
+// ownership masks instead and the tiles are appended row by row.
+void find_frontier_seeds(const Map &map, CountryId from, CountryId to, std::vector<TileIndex> &out);
+
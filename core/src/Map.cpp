@@ -1,7 +1,13 @@
 #include "Map.h"
+#include "Frontier.h"
 #include "MapTileTypes.h"
 #include "noise_wrapper.h"
+#include "TerrainCache.h"
+#include "Logging.h"
+#include "ThreadPool.h"
 #include "typedefs.h"
+#include <algorithm>
+#include <iterator>
 
 MapTileType get_tile_type(Elevation elevation) {
     if (elevation >= MapTileType::Mountain)
@@ -16,29 +22,150 @@ MapTileType get_tile_type(Elevation elevation) {
         return MapTileType::Water;
 }
 
-Map::Map(unsigned width, unsigned height) : width(width), height(height), tiles(width * height), noise() {
-    noise.SetNoiseType(FastNoiseLite::NoiseType::NoiseType_Perlin);
-    noise.SetFractalType(FastNoiseLite::FractalType_FBm);
-    noise.SetFractalOctaves(7);
-    noise.SetFractalLacunarity(2.0);
-    noise.SetFractalGain(0.47);
-    noise.SetFractalWeightedStrength(0.08);
+// the side of the smallest power of two square the map fits in
+static unsigned get_morton_side(unsigned width, unsigned height) {
+    unsigned side = 1;
+    while (side < width || side < height)
+        side *= 2;
+    return side;
+}
+
+// the water ring adds 2 tiles to every row
+static unsigned get_stride(unsigned width, const MapSettings &settings) {
+    unsigned stride = width + 2;
+    if (!settings.power_of_two_stride)
+        return stride;
+    unsigned padded = 1;
+    while (padded < stride)
+        padded *= 2;
+    return padded;
+}
+
+// 0 if the stride is not a power of two
+static unsigned get_stride_shift(unsigned stride) {
+    if ((stride & (stride - 1)) != 0)
+        return 0;
+    unsigned shift = 0;
+    while ((1u << shift) < stride)
+        shift++;
+    return shift;
+}
+
+Map::Map(unsigned width, unsigned height, const MapSettings &settings)
+    : width(width), height(height), layout(settings.layout), stride(get_stride(width, settings)), stride_shift(get_stride_shift(stride)),
+      morton(get_morton_side(width, height)), owners(get_tile_index_count()), types(get_tile_index_count()),
+      elevations(get_tile_index_count()), land_neighbors(get_tile_index_count()), terrain_settings(settings.terrain), border_index() {
+    // the tiles of the ring are never written, so they stay water
+    static_assert(MapTileType {} == MapTileType::Water, "the planes must start as water");
+    CONQORIAL_ASSERT_ALL(layout != TileLayout::Morton || morton.get_side() <= 32768, "The map is too big for the Morton layout",
+            std::cerr << "Size: " << width << 'x' << height << '\n';);
+
+    TerrainCache cache {settings.terrain_cache_directory};
+    bool loaded = cache.load(width, height, terrain_settings, [this](unsigned y, const uint8_t *elevation_row, const MapTileType *type_row) {
+        if (layout == TileLayout::RowMajor) {
+            std::copy_n(elevation_row, this->width, elevations.data() + get_tile_index(0, y));
+            std::copy_n(type_row, this->width, types.data() + get_tile_index(0, y));
+            return;
+        }
+        for (unsigned x = 0; x < this->width; x++) {
+            TileIndex index = get_tile_index(x, y);
+            elevations[index] = elevation_row[x];
+            types[index] = type_row[x];
+        }
+    });
+    ThreadPool pool {std::min(ThreadPool::resolve_thread_count(settings.generation_threads), height)};
+    if (!loaded) {
+        ElevationBatch batch {width, terrain_settings};
+
+        // every tile only depends on its coordinates, so bands of rows can be generated in parallel
+        pool.parallel_for(height, [this, &batch](unsigned y_begin, unsigned y_end) {
+            generate_rows(batch, y_begin, y_end);
+        });
+        cache.save(width, height, terrain_settings, [this](unsigned y, uint8_t *elevation_row, MapTileType *type_row) {
+            auto row_elevations = get_elevation_row(y);
+            std::copy(row_elevations.begin(), row_elevations.end(), elevation_row);
+            auto row_types = get_type_row(y);
+            std::copy(row_types.begin(), row_types.end(), type_row);
+        });
+    }
+    // the masks only read the finished types, so they can be split the same way
+    pool.parallel_for(height, [this](unsigned y_begin, unsigned y_end) {
+        compute_land_neighbors(y_begin, y_end);
+    });
+    terrain_components.build(*this);
 
+    border_index.reset(get_tile_index_count());
+    CONQORIAL_ASSERT_ALL((settings.chunk_size & (settings.chunk_size - 1)) == 0, "The chunk size must be a power of two",
+            std::cerr << "Chunk size: " << settings.chunk_size << '\n';);
+    chunk_index.reset(width, height, settings.chunk_size);
+}
 
-    unsigned index {};
+void Map::generate_rows(const ElevationBatch &batch, unsigned y_begin, unsigned y_end) {
+    std::vector<Elevation> row(width);
+    for (unsigned y = y_begin; y < y_end; y++) {
+        batch.get_row(y, 0, {row.data(), row.size()});
+        for (unsigned x = 0; x < width; x++) {
+            TileIndex index = get_tile_index(x, y);
+            auto elevation = row[x] * 100;
+            types[index] = get_tile_type(elevation);
+            elevations[index] = elevation;
+        }
+    }
+}
 
-    for (unsigned y = 0; y < height; y++) {
+void Map::compute_land_neighbors(unsigned y_begin, unsigned y_end) {
+    for (unsigned y = y_begin; y < y_end; y++) {
+        if (layout == TileLayout::RowMajor) {
+            // the same as below, but the neighbors are the next and previous tiles of 3 rows, which vectorizes
+            TileIndex first = get_tile_index(0, y);
+            const MapTileType *right = types.data() + first + 1;
+            const MapTileType *left = types.data() + first - 1;
+            const MapTileType *below = types.data() + first + stride;
+            const MapTileType *above = types.data() + first - stride;
+            uint8_t *masks = land_neighbors.data() + first;
+            for (unsigned x = 0; x < width; x++) {
+                masks[x] = (right[x] != MapTileType::Water) | (left[x] != MapTileType::Water) << 1 |
+                           (below[x] != MapTileType::Water) << 2 | (above[x] != MapTileType::Water) << 3;
+            }
+            continue;
+        }
         for (unsigned x = 0; x < width; x++) {
-            auto elevation = get_elevation(noise, x, y) * 100;
-            tiles[index].type = get_tile_type(elevation);
-            tiles[index].elevation = elevation;
-            index++;
+            TileIndex index = get_tile_index(x, y);
+            auto neighbors = get_tile_neighbors(index);
+            uint8_t mask = 0;
+            for (unsigned direction = 0; direction < neighbors.size(); direction++)
+                mask |= (types[neighbors[direction]] != MapTileType::Water) << direction;
+            land_neighbors[index] = mask;
         }
     }
 }
 
 void Map::set_tile(unsigned x, unsigned y, CountryId owner) {
-    tiles[y * width + x].owner = owner;
+    set_tile(get_tile_index(x, y), owner);
+}
+
+void Map::update_border_index(TileIndex tile, CountryId old_owner, CountryId new_owner) {
+    uint8_t foreign_neighbors = 0;
+    auto neighbors = get_tile_neighbors(tile);
+    for (unsigned land = land_neighbors[tile]; land != 0; land &= land - 1) {
+        TileIndex neighbor_index = neighbors[__builtin_ctz(land)];
+        CountryId neighbor_owner = owners[neighbor_index];
+
+        // the old edge between the tile and the neighbor
+        if (neighbor_owner != old_owner)
+            border_index.remove_shared_edge(old_owner, neighbor_owner);
+        else
+            border_index.change_foreign_neighbors(neighbor_index, neighbor_owner, +1);
+
+        // the new edge between the tile and the neighbor
+        if (neighbor_owner != new_owner) {
+            border_index.add_shared_edge(new_owner, neighbor_owner);
+            foreign_neighbors++;
+        } else
+            border_index.change_foreign_neighbors(neighbor_index, neighbor_owner, -1);
+    }
+
+    border_index.move_tile(tile, old_owner, new_owner, foreign_neighbors);
 }
 
 
@@ -47,11 +174,40 @@ void Map::set_tile(std::pair<unsigned, unsigned> pos, CountryId owner) {
 }
 
 void Map::set_tile(TileIndex pos, CountryId owner) {
-    set_tile(get_tile_coors(pos), owner);
+    CountryId old_owner = owners[pos];
+    if (old_owner == owner)
+        return;
+
+    owners[pos] = owner;
+    if (chunk_index.is_enabled()) {
+        auto [x, y] = get_tile_coors(pos);
+        chunk_index.move_tile(x, y, old_owner, owner);
+    }
+    if (types[pos] != MapTileType::Water)
+        update_border_index(pos, old_owner, owner);
+}
+
+void Map::transfer_tiles(Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner) {
+    if (old_owner == new_owner)
+        return;
+
+    bool rebuild_borders = tiles.size() > (size_t)width * height / border_rebuild_divisorCE;
+    for (TileIndex tile : tiles) {
+        CONQORIAL_DEBUG_ASSERT(owners[tile] == old_owner, std::string("A transferred tile is not owned by the old owner"));
+        owners[tile] = new_owner;
+        if (chunk_index.is_enabled()) {
+            auto [x, y] = get_tile_coors(tile);
+            chunk_index.move_tile(x, y, old_owner, new_owner);
+        }
+        if (!rebuild_borders && types[tile] != MapTileType::Water)
+            update_border_index(tile, old_owner, new_owner);
+    }
+    if (rebuild_borders)
+        rebuild_border_index();
 }
 
 MapTile Map::get_tile(unsigned x, unsigned y) const {
-    return tiles[y * width + x];
+    return get_tile(get_tile_index(x, y));
 }
 
 MapTile Map::get_tile(std::pair<unsigned, unsigned> pos) const {
@@ -59,7 +215,37 @@ MapTile Map::get_tile(std::pair<unsigned, unsigned> pos) const {
 }
 
 MapTile Map::get_tile(TileIndex pos) const {
-    return get_tile(get_tile_coors(pos));
+    return { elevations[pos], types[pos], owners[pos] };
+}
+
+template<typename T>
+Span<const T> Map::get_row(const TilePlane<T> &plane, unsigned y, unsigned x_begin, unsigned x_end) const {
+    if (layout == TileLayout::RowMajor)
+        return { plane.data() + get_tile_index(x_begin, y), x_end - x_begin };
+
+    // one buffer per plane type, CountryId and uint8_t are the same type
+    // so the owner and elevation rows share it
+    thread_local std::vector<T> row;
+    row.resize(x_end - x_begin);
+    for (unsigned x = x_begin; x < x_end; x++)
+        row[x - x_begin] = plane[get_tile_index(x, y)];
+    return { row.data(), row.size() };
+}
+
+Span<const CountryId> Map::get_owner_row(unsigned y) const {
+    return get_row(owners, y, 0, width);
+}
+
+Span<const MapTileType> Map::get_type_row(unsigned y) const {
+    return get_row(types, y, 0, width);
+}
+
+Span<const uint8_t> Map::get_elevation_row(unsigned y) const {
+    return get_row(elevations, y, 0, width);
+}
+
+const TerrainNoiseSettings &Map::get_terrain_settings() const {
+    return terrain_settings;
 }
 
 unsigned Map::get_width() const {
@@ -70,39 +256,136 @@ unsigned Map::get_height() const {
     return height;
 }
 
-TileIndex Map::get_tile_index(TileCoor x, TileCoor y) const {
-    return y * width + x;
+const TerrainComponents &Map::get_terrain_components() const {
+    return terrain_components;
+}
+
+TileLayout Map::get_layout() const {
+    return layout;
 }
 
 TileIndex Map::get_tile_index(std::pair<TileCoor, TileCoor> pos) const {
     return get_tile_index(pos.first, pos.second);
 }
 
-std::pair<TileCoor, TileCoor> Map::get_tile_coors(TileIndex index) const {
-    return { index % width, index / width };
+
+TileIndex Map::get_tile_index_count() const {
+    if (layout == TileLayout::Morton)
+        return morton.get_sentinel() + 1;
+    return stride * (height + 2);
+}
+
+unsigned Map::get_row_stride() const {
+    return stride;
 }
 
-Map::BorderResult Map::get_border(CountryId from, const std::map<CountryId, std::set<TileIndex>> &tiles_owned_by_country, std::optional<CountryId> to) const {
-    std::set<TileIndex> border;
+Map::BorderResult Map::get_border(CountryId from, std::optional<CountryId> to) const {
+    const std::vector<TileIndex> &border_tiles = border_index.get_border_tiles(from);
+    if (!to.has_value())
+        return {border_tiles, get_neighbors(from)};
+
+    std::vector<TileIndex> border;
     std::set<CountryId> neighbors;
-    constexpr int directions[4][2] = { {1,0}, {-1,0}, {0,1}, {0,-1} };
-    for (TileIndex tile : tiles_owned_by_country.at(from)) {
-        auto [x, y] = get_tile_coors(tile);
-        for (auto &dir : directions) {
-            int nx = x + dir[0];
-            int ny = y + dir[1];
-            if (nx >= 0 && nx < (int)get_width() && ny >= 0 && ny < (int)get_height()) {
-                MapTile neighbor = get_tile(nx, ny);
-                if (to.has_value() && neighbor.owner != to.value())
-                    continue;
-                if (neighbor.owner != from && neighbor.type != MapTileType::Water) {
-                    border.insert(get_tile_index(x, y));
-                    neighbors.insert(neighbor.owner);
-                }
-            }
+    find_frontier_seeds(*this, from, to.value(), border);
+    if (!border.empty())
+        neighbors.insert(to.value());
+    return {border, neighbors};
+}
+
+const std::vector<TileIndex> &Map::get_border_tiles(CountryId country) const {
+    return border_index.get_border_tiles(country);
+}
+
+std::set<CountryId> Map::get_neighbors(CountryId country) const {
+    std::set<CountryId> neighbors;
+    border_index.get_neighbors(country, std::inserter(neighbors, neighbors.end()));
+    return neighbors;
+}
+
+bool Map::shares_border(CountryId a, CountryId b) const {
+    return border_index.get_shared_edges(a, b) != 0;
+}
+
+void Map::rebuild_border_index() {
+    BorderSweep sweep;
+    sweep.sweep(*this);
+    border_index.rebuild(get_tile_index_count(), sweep);
+}
+
+bool Map::has_chunks() const {
+    return chunk_index.is_enabled();
+}
+
+const ChunkIndex &Map::get_chunks() const {
+    return chunk_index;
+}
+
+void Map::take_dirty_chunks(std::vector<unsigned> &out) {
+    chunk_index.take_dirty_chunks(out);
+}
+
+unsigned Map::scan_owned_tiles(CountryId country, const TileArea &area, bool stop_at_first) const {
+    unsigned count = 0;
+    for (unsigned y = area.y_begin; y < area.y_end; y++) {
+        for (CountryId owner : get_row(owners, y, area.x_begin, area.x_end))
+            count += owner == country;
+        if (stop_at_first && count != 0)
+            break;
+    }
+    return count;
+}
+
+unsigned Map::count_owned_tiles(CountryId country, const TileArea &area) const {
+    TileArea clipped = area.intersect({0, 0, width, height});
+    if (clipped.is_empty())
+        return 0;
+    if (!chunk_index.is_enabled())
+        return scan_owned_tiles(country, clipped, false);
+
+    unsigned count = 0;
+    unsigned chunk_size = chunk_index.get_chunk_size();
+    for (unsigned y = clipped.y_begin / chunk_size * chunk_size; y < clipped.y_end; y += chunk_size) {
+        for (unsigned x = clipped.x_begin / chunk_size * chunk_size; x < clipped.x_end; x += chunk_size) {
+            unsigned chunk = chunk_index.get_chunk(x, y);
+            unsigned owned = chunk_index.get_owner_count(chunk, country);
+            if (owned == 0)
+                continue;
+
+            TileArea chunk_area = chunk_index.get_chunk_area(chunk);
+            TileArea part = chunk_area.intersect(clipped);
+            if (owned == chunk_area.get_tile_count())
+                count += part.get_tile_count();
+            else if (part.get_tile_count() == chunk_area.get_tile_count())
+                count += owned;
+            else
+                count += scan_owned_tiles(country, part, false);
         }
     }
-    return {border, neighbors};
+    return count;
 }
 
+bool Map::owns_any_tile(CountryId country, const TileArea &area) const {
+    TileArea clipped = area.intersect({0, 0, width, height});
+    if (clipped.is_empty())
+        return false;
+    if (!chunk_index.is_enabled())
+        return scan_owned_tiles(country, clipped, true) != 0;
 
+    unsigned chunk_size = chunk_index.get_chunk_size();
+    for (unsigned y = clipped.y_begin / chunk_size * chunk_size; y < clipped.y_end; y += chunk_size) {
+        for (unsigned x = clipped.x_begin / chunk_size * chunk_size; x < clipped.x_end; x += chunk_size) {
+            unsigned chunk = chunk_index.get_chunk(x, y);
+            unsigned owned = chunk_index.get_owner_count(chunk, country);
+            if (owned == 0)
+                continue;
+
+            TileArea chunk_area = chunk_index.get_chunk_area(chunk);
+            TileArea part = chunk_area.intersect(clipped);
+            if (owned == chunk_area.get_tile_count() || part.get_tile_count() == chunk_area.get_tile_count())
+                return true;
+            if (scan_owned_tiles(country, part, true) != 0)
+                return true;
+        }
+    }
+    return false;
+}
@@ -1,22 +1,98 @@
 #ifndef MAP_H
 #define MAP_H
 
+#include <array>
 #include <vector>
-#include "FastNoiseLite/FastNoiseLite.h"
+#include "AlignedAllocator.h"
 #include "MapTile.h"
+#include "BorderIndex.h"
+#include "ChunkIndex.h"
+#include "noise_wrapper.h"
+#include "Span.h"
+#include "TerrainComponents.h"
+#include "TileGeometry.h"
 #include "typedefs.h"
 #include <set>
 #include <optional>
-#include <map>
+#include <string>
+
+constexpr unsigned default_chunk_sizeCE = 32;
+// Map::transfer_tiles sweeps the border index again instead of updating it
+// tile by tile once a batch has more than 1 / border_rebuild_divisorCE of the tiles of the map
+constexpr unsigned border_rebuild_divisorCE = 16;
+
+// the type of a tile with an elevation from 0 to 100
+MapTileType get_tile_type(Elevation elevation);
+
+struct MapSettings {
+    // how many threads generate the terrain, 0 means one per core
+    // the terrain is the same no matter how many threads are used
+    unsigned generation_threads = 0;
+    // the seed and the rest of the noise settings, the same settings always give the same terrain
+    TerrainNoiseSettings terrain;
+    // where generated terrain is saved and loaded from, empty means it is always generated
+    std::string terrain_cache_directory;
+    // the side of the chunks the owners are counted in (a power of two), 0 means no chunks
+    unsigned chunk_size = default_chunk_sizeCE;
+    // how the tiles are laid out in memory, the Morton layout is only possible
+    // for maps with both sides at most 32768 and needs a square power of two sized plane
+    TileLayout layout = TileLayout::RowMajor;
+    // pads the rows of the row major layout to a power of two, so tile indices turn back into
+    // coordinates with a shift and a mask instead of a division (in every tile transfer)
+    // this costs memory: with the water ring the rows of a power of two wide map double
+    bool power_of_two_stride = false;
+};
+
+// the planes start on a cache line so scans over them can use aligned SIMD loads
+constexpr size_t tile_plane_alignmentCE = 64;
+template<typename T>
+using TilePlane = std::vector<T, AlignedAllocator<T, tile_plane_alignmentCE>>;
+
+// the directions of the neighbors returned by Map::get_tile_neighbors: right, left, down, up
+constexpr int neighbor_directionsCE[4][2] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
 
 class Map {
     unsigned width;
     unsigned height;
+    TileLayout layout;
+    // the distance between the indices of 2 vertically adjacent tiles
+    unsigned stride;
+    // log2 of the stride if it is a power of two, 0 if get_tile_coors has to divide
+    unsigned stride_shift;
+    // only used by the Morton layout
+    MortonGeometry morton;
+
+    // the tiles are split into one plane per field (indexed by TileIndex),
+    // so a scan over the owners only reads the owners
+    // the planes have a ring of water tiles around the map (which nobody owns),
+    // so every tile of the map has 4 neighbors and neighbor loops need no bounds checks
+    // (in the Morton layout the padding up to the power of two square and the sentinel tile are the ring)
+    TilePlane<CountryId> owners;
+    TilePlane<MapTileType> types;
+    TilePlane<uint8_t> elevations;
+    // bit i is set if the neighbor in direction neighbor_directionsCE[i] is land,
+    // so neighbor loops can skip the water without reading its type
+    // the terrain never changes, so this is computed once with the map
+    TilePlane<uint8_t> land_neighbors;
+    TerrainNoiseSettings terrain_settings;
+    TerrainComponents terrain_components;
+    BorderIndex border_index;
+    ChunkIndex chunk_index;
 
-    std::vector<MapTile> tiles;
-    FastNoiseLite noise;
+    // generates the terrain of the rows [y_begin, y_end)
+    void generate_rows(const ElevationBatch &batch, unsigned y_begin, unsigned y_end);
+    // fills land_neighbors for the rows [y_begin, y_end)
+    void compute_land_neighbors(unsigned y_begin, unsigned y_end);
+    // counts the tiles of area (which must be inside the map) owned by the country by reading them
+    // if stop_at_first is true, it stops after finding one
+    unsigned scan_owned_tiles(CountryId country, const TileArea &area, bool stop_at_first) const;
+    // updates the border index after the tile went from old_owner to new_owner
+    void update_border_index(TileIndex tile, CountryId old_owner, CountryId new_owner);
+    // the tiles [x_begin, x_end) of row y of the plane
+    template<typename T>
+    Span<const T> get_row(const TilePlane<T> &plane, unsigned y, unsigned x_begin, unsigned x_end) const;
 public:
-    Map(unsigned width, unsigned height);
+    Map(unsigned width, unsigned height, const MapSettings &settings = {});
 
     // This should not be used outside of the Match and Attack class!
     void set_tile(unsigned x, unsigned y, CountryId owner);
@@ -24,22 +100,107 @@ public:
     void set_tile(std::pair<unsigned, unsigned> pos, CountryId owner);
     // This should not be used outside of the Match and Attack class!
     void set_tile(TileIndex pos, CountryId owner);
+    // This should not be used outside of the Match class!
+    // gives every tile (which must all be owned by old_owner) to new_owner,
+    // updating the chunk and border indices in the same pass
+    void transfer_tiles(Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner);
     MapTile get_tile(unsigned x, unsigned y) const;
     MapTile get_tile(std::pair<unsigned, unsigned> pos) const;
     MapTile get_tile(TileIndex pos) const;
 
+    CountryId get_owner(TileIndex pos) const { return owners[pos]; }
+    MapTileType get_type(TileIndex pos) const { return types[pos]; }
+    uint8_t get_elevation(TileIndex pos) const { return elevations[pos]; }
+    // bit i is set if the neighbor in direction neighbor_directionsCE[i] (and get_tile_neighbors(pos)[i]) is land
+    uint8_t get_land_neighbors(TileIndex pos) const { return land_neighbors[pos]; }
+    // the landmass or body of water the tile is part of, no_componentCE outside of the map
+    ComponentId get_component(TileIndex pos) const { return terrain_components.get_component(pos); }
+    // the landmasses and bodies of water, labelled once with the terrain
+    const TerrainComponents &get_terrain_components() const;
+
+    // the indices of the 4 neighbors of a tile of the map, in the order of neighbor_directionsCE
+    // the neighbors of the tiles on the edge can be tiles of the water ring
+    std::array<TileIndex, 4> get_tile_neighbors(TileIndex tile) const {
+        if (layout == TileLayout::Morton)
+            return morton.get_neighbors(tile);
+        return { tile + 1, tile - 1, tile + stride, tile - stride };
+    }
+
+    // the tiles of row y, from x = 0 to width - 1
+    // the Morton layout has no rows, there the row is copied into a buffer of the calling
+    // thread which stays valid until its next call of one of these
+    Span<const CountryId> get_owner_row(unsigned y) const;
+    Span<const MapTileType> get_type_row(unsigned y) const;
+    Span<const uint8_t> get_elevation_row(unsigned y) const;
+
+    const TerrainNoiseSettings &get_terrain_settings() const;
     unsigned get_width() const;
     unsigned get_height() const;
+    TileLayout get_layout() const;
 
-    TileIndex get_tile_index(TileCoor x, TileCoor y) const;
+    TileIndex get_tile_index(TileCoor x, TileCoor y) const {
+        if (layout == TileLayout::Morton)
+            return morton.encode(x, y);
+        return (y + 1) * stride + x + 1;
+    }
     TileIndex get_tile_index(std::pair<TileCoor, TileCoor> pos) const;
-    std::pair<TileCoor, TileCoor> get_tile_coors(TileIndex index) const;
+    // this is called for every captured tile, so it is inline
+    std::pair<TileCoor, TileCoor> get_tile_coors(TileIndex index) const {
+        if (layout == TileLayout::Morton) {
+            auto [x, y] = morton.decode(index);
+            return { x, y };
+        }
+        if (stride_shift != 0)
+            return { (index & (stride - 1)) - 1, (index >> stride_shift) - 1 };
+        return { index % stride - 1, index / stride - 1 };
+    }
+    // every TileIndex of this map (including the water ring) is smaller than this
+    // arrays indexed by TileIndex must have this size
+    TileIndex get_tile_index_count() const;
+    // only meaningful in the row major layout
+    unsigned get_row_stride() const;
 
     struct BorderResult {
-        std::set<TileIndex> border;
+        std::vector<TileIndex> border;
         std::set<CountryId> neighbors;
     };
-    BorderResult get_border(CountryId from, const std::map<CountryId, std::set<TileIndex>> &tiles_owned_by_country, std::optional<CountryId> to = std::nullopt) const;
+    // if to is given, only the border with that country is returned
+    // this costs O(size of the border of from), not O(size of from)
+    BorderResult get_border(CountryId from, std::optional<CountryId> to = std::nullopt) const;
+
+    // the land tiles of the country which have a land neighbor owned by someone else
+    const std::vector<TileIndex> &get_border_tiles(CountryId country) const;
+    // all the countries (including 0) that own land next to the country's land
+    std::set<CountryId> get_neighbors(CountryId country) const;
+    // true if a land tile of a is next to a land tile of b, this is O(1)
+    bool shares_border(CountryId a, CountryId b) const;
+    // builds the border index again with one sweep over the map
+    // set_tile keeps it up to date, this is for checking it and for changes too big to make one tile at a time
+    void rebuild_border_index();
+
+    bool has_chunks() const;
+    const ChunkIndex &get_chunks() const;
+    // appends the chunks where a tile changed owner since the last call to out
+    void take_dirty_chunks(std::vector<unsigned> &out);
+
+    // these only read the tiles of the chunks which are partly owned by the country
+    // and partly inside the area, the other chunks are answered by the chunk index
+    unsigned count_owned_tiles(CountryId country, const TileArea &area) const;
+    bool owns_any_tile(CountryId country, const TileArea &area) const;
+
+    // calls function(area) for every chunk where the country owns at least one tile
+    // or once with the whole map if there are no chunks
+    template<typename Function>
+    void for_each_area_owned_by(CountryId country, Function &&function) const {
+        if (!chunk_index.is_enabled()) {
+            function(TileArea {0, 0, width, height});
+            return;
+        }
+        for (unsigned chunk = 0; chunk < chunk_index.get_chunk_count(); chunk++) {
+            if (chunk_index.get_owner_count(chunk, country) != 0)
+                function(chunk_index.get_chunk_area(chunk));
+        }
+    }
 
 };
 
@@ -2,31 +2,35 @@
 #include "optional"
 #include "Logging.h"
 #include "typedefs.h"
+#include <stdexcept>
+#include <string>
 
 using namespace std::chrono;
 
-bool check_time_to_update(CQIntervalTimePoint last_update, std::chrono::milliseconds interval) {
-    auto now = steady_clock::now();
-    return duration_cast<milliseconds>(now - last_update) > interval;
-}
-
+Match::Match(unsigned width, unsigned height, std::optional<unsigned> seed, unsigned ai_country_count, const MapSettings &map_settings)
+    : countries {}, map {width, height, map_settings}, random {seed.has_value() ? RandomGenerator {*seed} : RandomGenerator {}},
+      clock {simulation_tick_intervalCE, max_catch_up_ticksCE} {
+    countries.add(Country { 0, "Neutral", {0, 0, 0} });
+    tiles_owned_by_country.reset(map.get_tile_index_count());
+    attack_stamps.reset(map.get_tile_index_count());
+    tiles_changed_stamps.reset(map.get_tile_index_count());
+    tiles_changed_stamps.next_generation();
 
-Match::Match(unsigned width, unsigned height): countries {}, map {width, height}, random {} {
-    countries.emplace(0, Country { 0, "Neutral", {0, 0, 0} });
-    tiles_owned_by_country[0] = {};
-
-    spawn_and_create_ai_countries();
+    spawn_and_create_ai_countries(ai_country_count);
 }
 
 const Country &Match::get_country(CountryId id) const {
     return countries.at(id);
 }
 
+size_t Match::get_country_tile_count(CountryId id) const {
+    return tiles_owned_by_country.size(id);
+}
+
 const Country &Match::new_country(std::string name, bool is_player, Color color) {
-    CountryId id = countries.size();
-    tiles_owned_by_country[id] = {};
+    CountryId id = countries.get_next_id();
     RandomGenerator *random_arg = is_player ? nullptr : &random;
-    return countries.insert({ id, Country { id, name, color, random_arg } }).first->second;
+    return countries.add(Country { id, name, color, random_arg });
 }
 
 std::vector<std::pair<TileCoor, TileCoor>> Match::spawn_country(CountryId id, TileCoor x, TileCoor y) {
@@ -46,20 +50,23 @@ std::vector<std::pair<TileCoor, TileCoor>> Match::spawn_country(CountryId id, Ti
         {x - 2, y + 1}, {x - 2, y - 1},
     };
     std::vector<std::pair<TileCoor, TileCoor>> result;
+    std::vector<TileIndex> spawn_tiles;
     for (auto &coord : coords) {
         if (coord.first < 0 || coord.first >= map.get_width() || coord.second < 0 || coord.second >= map.get_height())
             continue;
-        if (map.get_tile(coord).owner != 0 ||
-            map.get_tile(coord).type == MapTileType::Water)
+        TileIndex index = map.get_tile_index(coord);
+        if (map.get_owner(index) != 0 || map.get_type(index) == MapTileType::Water)
             continue;
-        set_map_tile(coord, id);
+        spawn_tiles.push_back(index);
         result.push_back(coord);
     }
+    transfer_tiles({spawn_tiles.data(), spawn_tiles.size()}, 0, id);
     return result;
 }
 
 void Match::set_game_started() {
     game_state = GameState::InGame;
+    clock.restart(steady_clock::now());
 }
 
 GameState Match::get_game_state() const {
@@ -71,89 +78,90 @@ void Match::new_alliance(CountryId id1, CountryId id2) {
     alliances[id2].push_back(id1);
 }
 
-std::vector<std::pair<TileCoor, TileCoor>> Match::tick() {
+Span<const TileIndex> Match::tick() {
     if (game_state != GameState::InGame)
         return {};
 
+    return simulate_ticks(clock.update(steady_clock::now()));
+}
 
-    std::vector<std::pair<TileCoor, TileCoor>> result;
-    auto now = steady_clock::now();
-    if (check_time_to_update(last_attack_update, attack_update_intervalCE)) {
-        last_attack_update = now;
-        auto tiles_changed = update_attacks();
-        result.insert(result.end(), tiles_changed.begin(), tiles_changed.end());
-    }
-    if (check_time_to_update(last_naval_inasion_update, naval_inasion_update_intervalCE)) {
-        last_naval_inasion_update = now;
-        auto tiles_changed = update_naval_inasions();
-        result.insert(result.end(), tiles_changed.begin(), tiles_changed.end());
-    }
-    if (check_time_to_update(last_population_update, population_update_intervalCE)) {
-        last_population_update = now;
+Span<const TileIndex> Match::simulate_ticks(unsigned tick_count) {
+    if (game_state != GameState::InGame)
+        return {};
+
+    tiles_changed.clear();
+    tiles_changed_stamps.next_generation();
+    for (unsigned i = 0; i < tick_count; i++)
+        run_simulation_tick();
+
+    return {tiles_changed.data(), tiles_changed.size()};
+}
+
+void Match::run_simulation_tick() {
+    current_tick++;
+    if (current_tick % attack_update_ticksCE == 0)
+        update_attacks();
+    if (current_tick % naval_inasion_update_ticksCE == 0)
+        update_naval_inasions();
+    if (current_tick % population_update_ticksCE == 0)
         update_populations();
-    }
-    if (check_time_to_update(last_ai_update, ai_update_intervalCE)) {
-        last_ai_update = now;
+    if (current_tick % ai_update_ticksCE == 0)
         update_ai_decisions();
-    }
+}
 
-    return result;
+SimulationTick Match::get_current_tick() const {
+    return current_tick;
 }
 
-std::vector<std::pair<TileCoor, TileCoor>> Match::update_attacks() {
-    std::vector<std::pair<TileCoor, TileCoor>> tiles_changed;
-    for (auto &[attacker, attacks] : on_going_attacks) {
-        for (auto it = attacks.begin(); it != attacks.end(); ++it) {
-            auto tiles_changed_this_attack = it->second.advance(map, countries, tiles_owned_by_country);
-            if (tiles_changed_this_attack.empty()) {
-                it = attacks.erase(it);
-                if (attacks.empty() || it == attacks.end())
-                    break;
-            }
-            tiles_changed.insert(tiles_changed.end(), tiles_changed_this_attack.begin(), tiles_changed_this_attack.end());
-        }
-    }
-    return tiles_changed;
+void Match::set_max_catch_up_ticks(unsigned ticks) {
+    clock.set_max_catch_up_ticks(ticks);
 }
 
-std::vector<std::pair<TileCoor, TileCoor>> Match::update_naval_inasions() {
-    std::vector<std::pair<TileCoor, TileCoor>> tiles_changed;
+void Match::update_attacks() {
+    on_going_attacks.update([this](Attack &attack) {
+        if (!attack.advance(map, countries, attack_stamps))
+            return false;
+        transfer_tiles(attack.get_captured_tiles(), attack.defender, attack.attacker);
+        return true;
+    });
+}
+
+void Match::update_naval_inasions() {
     for (auto &[attacker, naval_inasions] : naval_inasions) {
-        if (naval_inasions.empty())
-            continue;
-        for (auto it = naval_inasions.begin(); it != naval_inasions.end(); ++it) {
-            auto tiles_changed_this_attack = it->advance(map, tiles_owned_by_country, countries);
-            tiles_changed.insert(tiles_changed.end(), tiles_changed_this_attack.begin(), tiles_changed_this_attack.end());
-            if (tiles_changed_this_attack.empty() || it->is_done()) {
+        for (auto it = naval_inasions.begin(); it != naval_inasions.end();) {
+            if (!it->advance(map, tiles_owned_by_country, countries, tiles_changed) || it->is_done())
                 it = naval_inasions.erase(it);
-                if (naval_inasions.empty() || it == naval_inasions.end())
-                    break;
-            }
+            else
+                ++it;
         }
     }
-    return tiles_changed;
 }
 
-void Match::spawn_and_create_ai_countries() {
-    constexpr unsigned num_ai_countries = 15;
-    std::array<CountryId, num_ai_countries> ai_countries;
+void Match::spawn_and_create_ai_countries(unsigned ai_country_count) {
+    // leave room for the neutral country and a player
+    CONQORIAL_ASSERT_ALL(ai_country_count <= country_id_countCE - 2, "Too many AI countries",
+            ai_country_count = country_id_countCE - 2;);
+    std::vector<CountryId> ai_countries(ai_country_count);
 
-    for (unsigned i = 0; i < num_ai_countries; i++) {
+    for (unsigned i = 0; i < ai_country_count; i++) {
         ai_countries[i] = new_country("Bot " + std::to_string(i), false, {
                 static_cast<uint8_t>(random.randint(0, 255)),
                 static_cast<uint8_t>(random.randint(0, 255)),
                 static_cast<uint8_t>(random.randint(0, 255))
         }).id;
         
-        auto &country = countries.at(ai_countries[i]);
-        country.set_target_mobilization_level(country.ai_behavior->target_mobilization_level);
+        auto &country = countries[ai_countries[i]];
+        country.set_target_mobilization_level(country.details->ai_behavior->target_mobilization_level);
     }
 
+    if (ai_countries.empty())
+        return;
+
     auto current_ai_country {ai_countries.begin()};
-    for (unsigned tile = 0; tile < map.get_width() * map.get_height(); ++tile) {
-        if (map.get_tile(tile).owner != 0)
+    for (TileIndex tile = 0; tile < map.get_tile_index_count(); ++tile) {
+        if (map.get_owner(tile) != 0)
             continue;
-        if (map.get_tile(tile).type == MapTileType::Water)
+        if (map.get_type(tile) == MapTileType::Water)
             continue;
 
         spawn_country(*current_ai_country, random.randint(0, map.get_width() - 1), random.randint(0, map.get_height() - 1));
@@ -165,77 +173,106 @@ void Match::spawn_and_create_ai_countries() {
 }
 
 void Match::update_populations() {
-    for (auto &[id, country] : countries) {
-        auto number_tiles = tiles_owned_by_country[id].size();
+    territory_stats.shrink_bounds(map, tiles_owned_by_country);
+    for (Country &country : countries) {
+        auto number_tiles = territory_stats.get(country.id).tile_count;
         if (number_tiles == 0)
             continue;
-        auto current_population = country.pyramid.get_total_population();
-        auto economy = PyramidUtils::get_economy_score(country.pyramid, country.id, country.get_target_mobilization_level());
+        PopulationPyramid &pyramid = country.details->pyramid;
+        auto current_population = pyramid.get_total_population();
+        auto economy = PyramidUtils::get_economy_score(pyramid, country.details->economy_history, country.get_target_mobilization_level());
 
         country.set_economy(economy.score);
         country.set_density(current_population / number_tiles);
         country.add_money(economy.money_made);
-        country.pyramid.tick(economy.score, current_population / number_tiles, country.urbanization_level);
+        pyramid.tick(economy.score, current_population / number_tiles, country.urbanization_level);
         country.calculate_troops();
     }
 }
 
 void Match::update_ai_decisions() {
-    for (auto &[id, country] : countries) {
+    for (Country &country : countries) {
         if (country.is_human || country.id == 0)
             continue;
-        CONQORIAL_ASSERT_ALL(country.ai_behavior != std::nullopt, "Country has no AI behavior",
+        auto &ai_behavior = country.details->ai_behavior;
+        CONQORIAL_ASSERT_ALL(ai_behavior != std::nullopt, "Country has no AI behavior",
                 std::cerr << "Country id: " << (short)country.id << "\n";);
-        CQIntervalTimePoint now = std::chrono::steady_clock::now();
-        auto duration = now - country.ai_behavior->last_descision_check ;
-        if (duration_cast<milliseconds>(duration).count() < country.ai_behavior->check_decision_interval)
+        auto duration = (current_tick - ai_behavior->last_descision_check) * simulation_tick_intervalCE;
+        if (duration.count() < ai_behavior->check_decision_interval)
             continue;
 
-        auto [border, neighbors] = map.get_border(country.id, tiles_owned_by_country);
-        CountryId weakest_millitary_neighbor = neighbors.empty() ? 0 : *neighbors.begin();
-        for (CountryId neighbor : neighbors) {
-            if (countries.at(neighbor).get_military_score() < countries.at(weakest_millitary_neighbor).get_military_score())
-                weakest_millitary_neighbor = neighbor;
+        std::optional<CountryId> weakest_millitary_neighbor;
+        // only the inline fields of the neighbors are read, so this streams over the table
+        for (const Country &neighbor : countries) {
+            CountryId neighbor_id = neighbor.id;
+            if (!map.shares_border(country.id, neighbor_id))
+                continue;
+            if (!weakest_millitary_neighbor.has_value() ||
+                    neighbor.get_military_score() < countries[*weakest_millitary_neighbor].get_military_score())
+                weakest_millitary_neighbor = neighbor_id;
         }
-        Country &weakest_country = countries.at(weakest_millitary_neighbor);
+        Country &weakest_country = countries[weakest_millitary_neighbor.value_or(0)];
         CQ_LOG_DEBUG << "Weakest country: " << (short)weakest_country.id << "\n";
         if (weakest_country.get_military_score() < country.get_military_score() && random.rand_bool()) {
-            auto troops = country.get_troops() * ((100 - country.ai_behavior->reserve_troops) / 100.0);
+            auto troops = country.get_troops() * ((100 - ai_behavior->reserve_troops) / 100.0);
             CQ_LOG_DEBUG << "Attacking country " << (short)weakest_country.id << " with troops: " << troops << "\n";
             attack(country.id, weakest_country.id, troops);
         }
     }
 }
 
-void Match::attack(CountryId attacker, CountryId defender_id, unsigned troops_to_attack) {
+AttackHandle Match::attack(CountryId attacker, CountryId defender_id, unsigned troops_to_attack) {
+    // the attacks only check the ids in debug builds, so ids from the player are checked here
+    if (!countries.contains(defender_id))
+        throw std::out_of_range("There is no country with the id " + std::to_string(defender_id));
     bool able_to_attack = get_country(attacker).can_attack(defender_id, map);
 
     CQ_LOG_DEBUG << "Can attack: " << able_to_attack << "\n";
     if (!able_to_attack)
-        return;
-
-    std::optional<Country> defender {};
-    if (defender_id != 0)
-        defender = get_country(defender_id);
-
-    auto &ongoing_attacks_for_player = on_going_attacks[attacker];
-    bool attack_exists = ongoing_attacks_for_player.find(defender_id) != ongoing_attacks_for_player.end();
+        return {};
 
     // If the player is already attacking the defender, simply add troops to the attack.
-    if (attack_exists) {
-        ongoing_attacks_for_player.at(defender_id).troops_to_attack += troops_to_attack;
-        return;
+    AttackHandle existing = on_going_attacks.find(attacker, defender_id);
+    if (Attack *attack = on_going_attacks.get(existing)) {
+        attack->troops_to_attack += troops_to_attack;
+        return existing;
     }
 
-    ongoing_attacks_for_player.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(defender_id),
-        std::forward_as_tuple(attacker, defender_id, troops_to_attack)
-    );
+    return on_going_attacks.start(attacker, defender_id, troops_to_attack);
 }
 
+const Attack *Match::get_attack(AttackHandle handle) const {
+    return on_going_attacks.get(handle);
+}
+
+
+bool Match::can_naval_invade(CountryId attacker, TileIndex destination_tile) const {
+    if (destination_tile >= map.get_tile_index_count())
+        return false;
+    ComponentId destination = map.get_component(destination_tile);
+    if (destination == no_componentCE || map.get_type(destination_tile) == MapTileType::Water ||
+            map.get_owner(destination_tile) == attacker)
+        return false;
+
+    // the tiles of a country are mostly on one landmass, so each landmass is usually only checked once
+    const TerrainComponents &components = map.get_terrain_components();
+    ComponentId last_checked = no_componentCE;
+    for (TileIndex tile : tiles_owned_by_country.get_tiles(attacker)) {
+        ComponentId landmass = map.get_component(tile);
+        if (landmass == last_checked)
+            continue;
+        if (components.are_connected_by_water(landmass, destination))
+            return true;
+        last_checked = landmass;
+    }
+    return false;
+}
 
 void Match::naval_invade(CountryId attacker, TileIndex destination_tile, unsigned troops_to_attack) {
+    if (!can_naval_invade(attacker, destination_tile)) {
+        CQ_LOG_DEBUG << "Country " << (short)attacker << " can not reach tile " << destination_tile << " by sea\n";
+        return;
+    }
     auto &ongoing_naval_inasions_for_player = naval_inasions[attacker];
     ongoing_naval_inasions_for_player.emplace_back(destination_tile, get_country(attacker).get_id(), troops_to_attack, map);
 }
@@ -245,15 +282,46 @@ const Map &Match::get_map() const {
     return map;
 }
 
+void Match::take_dirty_map_chunks(std::vector<unsigned> &out) {
+    map.take_dirty_chunks(out);
+}
+
+void Match::transfer_tiles(Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner) {
+    if (old_owner == new_owner || tiles.empty())
+        return;
+
+    for (TileIndex tile : tiles) {
+        // the tile has to leave the old owner's set before joining the new one
+        bool removed = tiles_owned_by_country.erase(old_owner, tile);
+        if (old_owner != 0) {
+            CONQORIAL_ASSERT_ALL(removed, "The country which owns the tile does not have it in their tiles_owned_by_country set",
+                    std::cerr << "Country: " << (short)old_owner << "\n";);
+        }
+        tiles_owned_by_country.insert(new_owner, tile);
+        // a tile captured twice in a tick (eg. taken back by a counter attack) is only listed once
+        if (tiles_changed_stamps.mark(tile))
+            tiles_changed.push_back(tile);
+    }
+    territory_stats.transfer(map, tiles, old_owner, new_owner);
+    map.transfer_tiles(tiles, old_owner, new_owner);
+    tile_changes.publish(current_tick, tiles, old_owner, new_owner);
+}
+
+const TileChangeJournal &Match::get_tile_changes() const {
+    return tile_changes;
+}
+
+const CountryTerritory &Match::get_country_territory(CountryId id) const {
+    return territory_stats.get(id);
+}
+
+const TerritoryStats &Match::get_territory_stats() const {
+    return territory_stats;
+}
+
 void Match::set_map_tile(TileCoor x, TileCoor y, CountryId owner) {
     TileIndex index = map.get_tile_index(x, y);
-    tiles_owned_by_country[owner].insert(index);
-    auto removed = tiles_owned_by_country[map.get_tile(x, y).owner].erase(index);
-    if (map.get_tile(x, y).owner != 0) {
-        CONQORIAL_ASSERT_ALL(removed != 0, "The country which owns the tile does not have it in their tiles_owned_by_country set",
-                std::cerr << "Country: " << (short)map.get_tile(x, y).owner << "\n";);
-    }
-    map.set_tile(x, y, owner);
+    transfer_tiles({&index, 1}, map.get_owner(index), owner);
 }
 
 void Match::set_map_tile(std::pair<TileCoor, TileCoor> pos, CountryId owner) {
@@ -276,6 +344,6 @@ void Match::upgrade_country_millitary(CountryId id) {
     countries.at(id).upgrade_millitary_level();
 }
 
-const std::map<CountryId, Country> &Match::get_countries() const {
+const CountryTable &Match::get_countries() const {
     return countries;
 }
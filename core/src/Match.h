@@ -1,48 +1,85 @@
 #pragma once
 
 #include "Country.h"
+#include "CountryTable.h"
 #include "Map.h"
 #include "Attack.h"
+#include "AttackTable.h"
+#include "Frontier.h"
 #include <map>
+#include <optional>
 #include <vector>
 #include <chrono>
 #include "GameState.h"
 #include "NavalInvasion.h"
 #include "RandomGenerator.h"
+#include "SimulationClock.h"
+#include "TerritoryIndex.h"
+#include "TerritoryStats.h"
+#include "TileChangeJournal.h"
 #include "typedefs.h"
 
 // CE stands for constexpr
+// the length of one simulation tick, every interval below has to be a multiple of it
+constexpr std::chrono::milliseconds simulation_tick_intervalCE { 50 };
 constexpr std::chrono::milliseconds attack_update_intervalCE { 50 };
 constexpr std::chrono::milliseconds naval_inasion_update_intervalCE { 50 };
 constexpr std::chrono::milliseconds population_update_intervalCE { 2'000 };
 constexpr std::chrono::milliseconds ai_update_intervalCE { 500 };
 
+// the same intervals in simulation ticks
+constexpr SimulationTick attack_update_ticksCE = attack_update_intervalCE / simulation_tick_intervalCE;
+constexpr SimulationTick naval_inasion_update_ticksCE = naval_inasion_update_intervalCE / simulation_tick_intervalCE;
+constexpr SimulationTick population_update_ticksCE = population_update_intervalCE / simulation_tick_intervalCE;
+constexpr SimulationTick ai_update_ticksCE = ai_update_intervalCE / simulation_tick_intervalCE;
+
+// how many ticks tick() may run at once when the game falls behind real time
+constexpr unsigned max_catch_up_ticksCE = 10;
+
+constexpr unsigned default_ai_country_countCE = 15;
+
 class Match {
     GameState game_state = GameState::SelectingStartingPoint;
-    std::map<CountryId, Country> countries;
-    std::map<CountryId, std::set<TileIndex>> tiles_owned_by_country;
+    CountryTable countries;
+    TerritoryIndex tiles_owned_by_country;
+    // the tile counts, bounds and centroids of every country, kept with tiles_owned_by_country
+    TerritoryStats territory_stats;
     Map map;
     std::map<CountryId, std::vector<CountryId>> alliances;
-    std::map<CountryId, std::map<CountryId, Attack>> on_going_attacks;
+    AttackTable on_going_attacks;
     std::map<CountryId, std::vector<NavalInvasion>> naval_inasions;
     RandomGenerator random;
 
-    CQIntervalTimePoint last_population_update;
-    CQIntervalTimePoint last_attack_update;
-    CQIntervalTimePoint last_naval_inasion_update;
-    CQIntervalTimePoint last_ai_update;
+    // used by the attacks to deduplicate the tiles they capture
+    TileStampSet attack_stamps;
+    // the tiles changed during the current tick, each one once, reused between ticks
+    std::vector<TileIndex> tiles_changed;
+    // the tiles already in tiles_changed, a new generation every tick
+    TileStampSet tiles_changed_stamps;
+    // every ownership change, read by the client at its own pace
+    TileChangeJournal tile_changes;
+
+    SimulationClock clock;
+    SimulationTick current_tick = 0;
 
     void update_populations();
-    std::vector<std::pair<TileCoor, TileCoor>> update_attacks();
-    std::vector<std::pair<TileCoor, TileCoor>> update_naval_inasions();
+    // these change tiles through transfer_tiles, which adds them to tiles_changed
+    void update_attacks();
+    void update_naval_inasions();
     void update_ai_decisions();
+    // advances every subsystem that is due by one simulation tick
+    void run_simulation_tick();
 
-    void spawn_and_create_ai_countries();
+    void spawn_and_create_ai_countries(unsigned ai_country_count);
 
 public:
-    Match(unsigned width, unsigned height);
+    // matches created with the same seed and given the same inputs play out the same way
+    Match(unsigned width, unsigned height, std::optional<unsigned> seed = std::nullopt,
+          unsigned ai_country_count = default_ai_country_countCE, const MapSettings &map_settings = {});
 
     const Country &get_country(CountryId id) const;
+    // the number of tiles the country owns
+    size_t get_country_tile_count(CountryId id) const;
     const Country &new_country(std::string name, bool is_player, Color color);
     std::vector<std::pair<TileCoor, TileCoor>> spawn_country(CountryId id, TileCoor x, TileCoor y);
 
@@ -51,10 +88,27 @@ public:
     
     void new_alliance(CountryId id1, CountryId id2);
 
-    void attack(CountryId attacker, CountryId defender_id, unsigned troops_to_attack);
+    // adds the troops to the attack if the attacker is already attacking the defender
+    // returns an invalid handle if the attacker cannot attack the defender
+    AttackHandle attack(CountryId attacker, CountryId defender_id, unsigned troops_to_attack);
+    // nullptr once the attack is over
+    const Attack *get_attack(AttackHandle handle) const;
+    // true if the destination is land of someone else and a body of water touches
+    // both its landmass and a landmass where the attacker owns tiles
+    bool can_naval_invade(CountryId attacker, TileIndex destination_tile) const;
     void naval_invade(CountryId attacker, TileIndex destination_tile, unsigned troops_to_attack);
 
     const Map &get_map() const;
+    // appends the map chunks where a tile changed owner since the last call to out
+    void take_dirty_map_chunks(std::vector<unsigned> &out);
+    // gives the tiles (which must all be owned by old_owner) to new_owner, updating the map,
+    // its indices, the tiles of each country and the changed tiles of this tick in one go
+    // and publishes the changes to the tile change journal
+    void transfer_tiles(Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner);
+    const TileChangeJournal &get_tile_changes() const;
+    // the bounds may be a bit too big, they are made exact again every population update
+    const CountryTerritory &get_country_territory(CountryId id) const;
+    const TerritoryStats &get_territory_stats() const;
     void set_map_tile(TileCoor x, TileCoor y, CountryId owner);
     void set_map_tile(std::pair<TileCoor, TileCoor> pos, CountryId owner);
     MapTile get_map_tile(TileCoor x, TileCoor y) const;
@@ -63,9 +117,18 @@ public:
     void set_country_target_mobilization_level(CountryId id, uint8_t level);
     void upgrade_country_millitary(CountryId id);
 
-    const std::map<CountryId, Country> &get_countries() const;
+    const CountryTable &get_countries() const;
 
     // updates the state of the game, should be called every frame or as often as possible
-    // returns a list of tiles that have changed
-    std::vector<std::pair<TileCoor, TileCoor>> tick();
+    // it runs as many fixed length simulation ticks as fit in the time since the last call
+    // returns the tiles that have changed, each one once
+    // the span stays valid until the next call to tick() or simulate_ticks()
+    Span<const TileIndex> tick();
+    // runs exactly tick_count simulation ticks right away, no matter how much time has passed
+    // this lets a match run faster than real time
+    // returns the tiles that have changed like tick()
+    Span<const TileIndex> simulate_ticks(unsigned tick_count);
+
+    SimulationTick get_current_tick() const;
+    void set_max_catch_up_ticks(unsigned ticks);
 };
@@ -7,7 +7,8 @@ NavalInvasion::NavalInvasion(TileIndex destination, CountryId attacker, unsigned
     : remaining_troops {troops}, attacker {attacker} {
 }
 
-std::set<std::pair<TileCoor, TileCoor>> NavalInvasion::advance(Map &map, std::map<CountryId, std::set<TileIndex>> &tiles_owned_by_country, std::map<CountryId, Country> &countries) {
+bool NavalInvasion::advance(Map &map, TerritoryIndex &tiles_owned_by_country, CountryTable &countries, std::vector<TileIndex> &tiles_changed) {
+    return false;
 }
 
 bool NavalInvasion::is_done() const {
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "typedefs.h"
-#include "Country.h"
-#include <set>
+#include "CountryTable.h"
+#include "TerritoryIndex.h"
 #include <vector>
 
 struct NavalInvasion {
@@ -21,7 +21,9 @@ struct NavalInvasion {
 
     NavalInvasion(TileIndex destination, CountryId attacker, unsigned troops, const Map &map);
 
-    std::set<std::pair<TileCoor, TileCoor>> advance(Map &map, std::map<CountryId, std::set<TileIndex>> &tiles_owned_by_country, std::map<CountryId, Country> &countries);
+    // appends the tiles it captured to tiles_changed
+    // returns false when the invasion is over
+    bool advance(Map &map, TerritoryIndex &tiles_owned_by_country, CountryTable &countries, std::vector<TileIndex> &tiles_changed);
     bool is_done() const;
 };
 
@@ -0,0 +1,97 @@
+#include "OwnershipMask.h"
+#include "MapTileTypes.h"
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void OwnershipMask::resize(unsigned width, unsigned height) {
+    this->width = width;
+    this->height = height;
+    words_per_row = (width + 63) / 64;
+    words.assign((size_t)words_per_row * height, 0);
+}
+
+uint64_t OwnershipMask::get_last_word_mask() const {
+    unsigned used_bits = width % 64;
+    return used_bits == 0 ? ~0ULL : (1ULL << used_bits) - 1;
+}
+
+void OwnershipMask::build(const Map &map, CountryId country) {
+    resize(map.get_width(), map.get_height());
+    for (unsigned y = 0; y < height; y++) {
+        const CountryId *owners = map.get_owner_row(y).data();
+        const MapTileType *types = map.get_type_row(y).data();
+        uint64_t *row = words.data() + (size_t)y * words_per_row;
+
+        unsigned x = 0;
+#ifdef __SSE2__
+        // 16 tiles per compare, movemask packs the results into bits
+        const __m128i country_bytes = _mm_set1_epi8(country);
+        const __m128i water_bytes = _mm_set1_epi8(static_cast<char>(MapTileType::Water));
+        for (; x + 16 <= width; x += 16) {
+            __m128i owned = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(owners + x)), country_bytes);
+            __m128i water = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(types + x)), water_bytes);
+            uint64_t bits = static_cast<unsigned>(_mm_movemask_epi8(_mm_andnot_si128(water, owned)));
+            row[x / 64] |= bits << (x % 64);
+        }
+#endif
+        for (; x < width; x++)
+            row[x / 64] |= (uint64_t)(owners[x] == country && types[x] != MapTileType::Water) << (x % 64);
+    }
+}
+
+void OwnershipMask::dilate(OwnershipMask &out) const {
+    out.resize(width, height);
+    uint64_t last_word_mask = get_last_word_mask();
+    for (unsigned y = 0; y < height; y++) {
+        const uint64_t *row = words.data() + (size_t)y * words_per_row;
+        const uint64_t *above = y > 0 ? row - words_per_row : nullptr;
+        const uint64_t *below = y + 1 < height ? row + words_per_row : nullptr;
+        uint64_t *out_row = out.words.data() + (size_t)y * words_per_row;
+        for (unsigned word = 0; word < words_per_row; word++) {
+            // the left and right neighbors, with the bits that cross into the next and previous word
+            uint64_t bits = row[word] | (row[word] << 1) | (row[word] >> 1);
+            if (word > 0)
+                bits |= row[word - 1] >> 63;
+            if (word + 1 < words_per_row)
+                bits |= row[word + 1] << 63;
+            if (above != nullptr)
+                bits |= above[word];
+            if (below != nullptr)
+                bits |= below[word];
+            out_row[word] = bits;
+        }
+        // the shift to the left can push a bit past the end of the row
+        out_row[words_per_row - 1] &= last_word_mask;
+    }
+}
+
+void OwnershipMask::intersect(const OwnershipMask &other) {
+    for (size_t i = 0; i < words.size(); i++)
+        words[i] &= other.words[i];
+}
+
+bool OwnershipMask::contains(unsigned x, unsigned y) const {
+    return (words[(size_t)y * words_per_row + x / 64] >> (x % 64)) & 1;
+}
+
+uint64_t OwnershipMask::count() const {
+    uint64_t total = 0;
+    for (uint64_t word : words)
+        total += __builtin_popcountll(word);
+    return total;
+}
+
+void find_border_with_masks(const Map &map, CountryId from, CountryId to, BorderMasks &masks, std::vector<TileIndex> &out) {
+    if (from == to)
+        return;
+    masks.from.build(map, from);
+    masks.to.build(map, to);
+    masks.to.dilate(masks.next_to);
+    masks.from.intersect(masks.next_to);
+    masks.from.for_each_tile([&map, &out](unsigned x, unsigned y) {
+        out.push_back(map.get_tile_index(x, y));
+    });
+}
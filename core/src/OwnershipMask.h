@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Map.h"
+#include "typedefs.h"
+#include <cstdint>
+#include <vector>
+
+// One bit per tile of the map, set for the land tiles owned by one country.
+// Bit x % 64 of word x / 64 of a row is the tile at x, so the whole-map
+// operations below work on 64 tiles at a time.
+// The bits after the end of a row are always 0.
+class OwnershipMask {
+    unsigned width = 0;
+    unsigned height = 0;
+    unsigned words_per_row = 0;
+    std::vector<uint64_t> words;
+
+    void resize(unsigned width, unsigned height);
+    // the valid bits of the last word of a row
+    uint64_t get_last_word_mask() const;
+
+public:
+    OwnershipMask() = default;
+
+    // reads every owner and type of the map, so this costs O(size of the map)
+    void build(const Map &map, CountryId country);
+
+    // out has the tiles of this mask and their 4 neighbors (out must not be this mask)
+    void dilate(OwnershipMask &out) const;
+    // keeps only the tiles that are also in other, which must have the same size
+    void intersect(const OwnershipMask &other);
+
+    bool contains(unsigned x, unsigned y) const;
+    uint64_t count() const;
+
+    // calls function(x, y) for every tile in the mask, row by row
+    template<typename Function>
+    void for_each_tile(Function &&function) const {
+        for (unsigned y = 0; y < height; y++) {
+            const uint64_t *row = words.data() + (size_t)y * words_per_row;
+            for (unsigned word = 0; word < words_per_row; word++) {
+                for (uint64_t bits = row[word]; bits != 0; bits &= bits - 1)
+                    function(word * 64 + __builtin_ctzll(bits), y);
+            }
+        }
+    }
+};
+
+// find_frontier_seeds uses the masks once the border of from has more than
+// 1 / mask_border_divisorCE of the tiles of the map, going through the border
+// costs about 10 times as much per tile as the masks do per map tile
+constexpr unsigned mask_border_divisorCE = 8;
+
+// the masks used by find_border_with_masks, kept between calls to avoid allocations
+struct BorderMasks {
+    OwnershipMask from;
+    OwnershipMask to;
+    OwnershipMask next_to;
+};
+
+// Appends the land tiles of from that are next to land owned by to to out, row by row,
+// like find_frontier_seeds but by scanning the whole map with masks instead of
+// walking the border of from.
+void find_border_with_masks(const Map &map, CountryId from, CountryId to, BorderMasks &masks, std::vector<TileIndex> &out);
@@ -2,7 +2,6 @@
 #include "Logging.h"
 #include "typedefs.h"
 #include <algorithm>
-#include <map>
 #include "cq_utils.h"
 
 double sigmoid(double x) {
@@ -101,30 +100,27 @@ const std::array<PyramidPiece, 20> &PopulationPyramid::get_pieces() const {
 
 
 void PopulationPyramid::remove_casualties(unsigned casualties) {
-    auto troops_to_remove_each_piece {casualties / num_reproductive_age_groups};
-
-    for (int i = 0; i < 2; ++i) {
-    for (auto &piece : pieces) {
-        if (piece.age >= reproductive_age_min && piece.age <= reproductive_age_max) {
-            if (piece.female_count > troops_to_remove_each_piece) {
-                piece.female_count -= troops_to_remove_each_piece;
-                casualties -= troops_to_remove_each_piece;
-            } else {
-                troops_to_remove_each_piece += troops_to_remove_each_piece - piece.female_count;
-                piece.female_count = 0;
-            }
+    // the casualties are split evenly between the men and women of the reproductive age groups,
+    // what a group can not pay (or what is left after the split) is taken in the next rounds
+    while (casualties != 0) {
+        unsigned groups_left = 0;
+        for (const auto &piece : pieces) {
+            if (piece.age >= reproductive_age_min && piece.age <= reproductive_age_max)
+                groups_left += (piece.female_count != 0) + (piece.male_count != 0);
+        }
+        if (groups_left == 0)
+            break;
 
-            if (piece.male_count > troops_to_remove_each_piece) {
-                piece.male_count -= troops_to_remove_each_piece;
-                casualties -= troops_to_remove_each_piece;
-            } else {
-                troops_to_remove_each_piece += troops_to_remove_each_piece - piece.male_count;
-                piece.male_count = 0;
+        unsigned long troops_to_remove_each_group {std::max(casualties / groups_left, 1u)};
+        for (auto &piece : pieces) {
+            if (piece.age < reproductive_age_min || piece.age > reproductive_age_max)
+                continue;
+            for (unsigned long *count : {&piece.female_count, &piece.male_count}) {
+                unsigned long removed {std::min({troops_to_remove_each_group, *count, (unsigned long)casualties})};
+                *count -= removed;
+                casualties -= removed;
             }
         }
-        if (casualties == 0)
-            break;
-    }
     }
     CONQORIAL_ASSERT_ALL(casualties == 0, "Tried to remove more troops than owned");
 }
@@ -138,13 +134,8 @@ void PopulationPyramid::update_total_population() {
 
 namespace PyramidUtils {
 
-EconomyResult get_economy_score(const PopulationPyramid &pyramid, CountryId country, uint8_t target_mobilization_level) {
-    // the unsigned is number of times the economy was calucated
-    static std::map<CountryId, std::pair<unsigned, double>> avg_money_made {};
-    if (avg_money_made.find(country) == avg_money_made.end())
-        avg_money_made[country] = {0, 0.0};
-
-    auto &[num_times_calculated, avg_money] = avg_money_made[country];
+EconomyResult get_economy_score(const PopulationPyramid &pyramid, EconomyHistory &history, uint8_t target_mobilization_level) {
+    auto &[num_times_calculated, avg_money] = history;
 
     double mobilization_percent {target_mobilization_level / 100.0};
 
@@ -40,7 +40,8 @@ public:
 
     const std::array<PyramidPiece, 20> &get_pieces() const;
 
-    // removes casualties from attacks
+    // removes casualties from attacks, split evenly between the men and women of the
+    // reproductive age groups (groups that run out are skipped)
     void remove_casualties(unsigned casualties);
 
     void update_total_population();
@@ -48,12 +49,20 @@ public:
 
 namespace PyramidUtils {
 
+// the running average of the money a country made, kept per country
+// so every match has its own economy history
+struct EconomyHistory {
+    // number of times the economy was calculated
+    unsigned times_calculated = 0;
+    double average_money_made = 0.0;
+};
+
 struct EconomyResult {
     unsigned score;
     int money_made;
 };
 
-EconomyResult get_economy_score(const PopulationPyramid &pyramid, CountryId country, uint8_t target_mobilization_level);
+EconomyResult get_economy_score(const PopulationPyramid &pyramid, EconomyHistory &history, uint8_t target_mobilization_level);
 
 }
 
@@ -0,0 +1,30 @@
+#include "SimulationClock.h"
+
+SimulationClock::SimulationClock(std::chrono::milliseconds tick_duration, unsigned max_catch_up_ticks)
+    : tick_duration {tick_duration}, max_catch_up_ticks {max_catch_up_ticks},
+      accumulator {0}, last_update {std::chrono::steady_clock::now()} {
+}
+
+void SimulationClock::restart(CQIntervalTimePoint now) {
+    accumulator = std::chrono::nanoseconds {0};
+    last_update = now;
+}
+
+unsigned SimulationClock::update(CQIntervalTimePoint now) {
+    accumulator += now - last_update;
+    last_update = now;
+
+    auto ticks = accumulator / tick_duration;
+    accumulator -= ticks * tick_duration;
+    if (ticks > max_catch_up_ticks)
+        ticks = max_catch_up_ticks;
+    return ticks;
+}
+
+unsigned SimulationClock::get_max_catch_up_ticks() const {
+    return max_catch_up_ticks;
+}
+
+void SimulationClock::set_max_catch_up_ticks(unsigned ticks) {
+    max_catch_up_ticks = ticks;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "typedefs.h"
+#include <chrono>
+
+// Turns wall clock time into a number of fixed length simulation ticks.
+// Elapsed time is accumulated and every full tick_duration becomes one tick,
+// so the amount of simulation per second does not depend on the frame rate.
+class SimulationClock {
+    std::chrono::nanoseconds tick_duration;
+    // if the game falls behind by more than this many ticks, the extra time is dropped
+    unsigned max_catch_up_ticks;
+    std::chrono::nanoseconds accumulator;
+    CQIntervalTimePoint last_update;
+
+public:
+    SimulationClock(std::chrono::milliseconds tick_duration, unsigned max_catch_up_ticks);
+
+    // forgets all the accumulated time and starts counting from now
+    void restart(CQIntervalTimePoint now);
+    // returns the number of ticks that should be simulated since the last update
+    unsigned update(CQIntervalTimePoint now);
+
+    unsigned get_max_catch_up_ticks() const;
+    void set_max_catch_up_ticks(unsigned ticks);
+};
+
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+// A view of size contiguous elements, like std::span (which needs C++20)
+template<typename T>
+class Span {
+    T *pointer = nullptr;
+    size_t count = 0;
+
+public:
+    Span() = default;
+    Span(T *pointer, size_t count) : pointer(pointer), count(count) {}
+
+    T *data() const { return pointer; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T &operator[](size_t index) const { return pointer[index]; }
+    T *begin() const { return pointer; }
+    T *end() const { return pointer + count; }
+
+    Span subspan(size_t offset, size_t length) const { return {pointer + offset, length}; }
+};
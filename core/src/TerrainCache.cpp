@@ -0,0 +1,233 @@
+#include "TerrainCache.h"
+#include "Logging.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONQORIAL_TERRAIN_CACHE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct TerrainCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint64_t key;
+};
+static_assert(sizeof(TerrainCacheHeader) == 24, "the header is written as is, it must not have padding");
+
+// the whole file in memory, either mapped or read into a buffer
+class FileContents {
+    const unsigned char *data = nullptr;
+    size_t size = 0;
+#ifdef CONQORIAL_TERRAIN_CACHE_MMAP
+    void *mapping = nullptr;
+#else
+    std::vector<unsigned char> buffer;
+#endif
+
+public:
+    FileContents() = default;
+    FileContents(const FileContents &) = delete;
+    FileContents &operator=(const FileContents &) = delete;
+
+    ~FileContents() {
+#ifdef CONQORIAL_TERRAIN_CACHE_MMAP
+        if (mapping != nullptr)
+            munmap(mapping, size);
+#endif
+    }
+
+    bool open(const std::string &path) {
+#ifdef CONQORIAL_TERRAIN_CACHE_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void *result = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (result == MAP_FAILED)
+            return false;
+        mapping = result;
+        data = static_cast<const unsigned char *>(result);
+        size = info.st_size;
+#else
+        std::ifstream file {path, std::ios::binary | std::ios::ate};
+        if (!file)
+            return false;
+        buffer.resize(file.tellg());
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char *>(buffer.data()), buffer.size()))
+            return false;
+        data = buffer.data();
+        size = buffer.size();
+#endif
+        return true;
+    }
+
+    const unsigned char *get_data() const { return data; }
+    size_t get_size() const { return size; }
+};
+
+// FNV-1a
+void hash_bytes(uint64_t &hash, const void *bytes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        hash ^= static_cast<const unsigned char *>(bytes)[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+template<typename T>
+void hash_value(uint64_t &hash, T value) {
+    hash_bytes(hash, &value, sizeof(value));
+}
+
+bool is_map_tile_type(unsigned char value) {
+    switch (static_cast<MapTileType>(value)) {
+    case MapTileType::Water:
+    case MapTileType::Beach:
+    case MapTileType::Grass:
+    case MapTileType::Hill:
+    case MapTileType::Mountain:
+        return true;
+    }
+    return false;
+}
+
+// a name for the temporary file of a save that no other save (in this or another process) uses
+std::string get_temporary_path(const std::string &path) {
+#ifdef CONQORIAL_TERRAIN_CACHE_MMAP
+    static const unsigned long process_id = getpid();
+#else
+    static const unsigned long process_id = std::random_device {}();
+#endif
+    static std::atomic<unsigned> save_count {0};
+    std::ostringstream temporary_path;
+    temporary_path << path << '.' << process_id << '.' << save_count++ << ".tmp";
+    return temporary_path.str();
+}
+
+} // namespace
+
+TerrainCache::TerrainCache(std::string directory) : directory(std::move(directory)) {}
+
+bool TerrainCache::is_enabled() const {
+    return !directory.empty();
+}
+
+uint64_t TerrainCache::get_key(unsigned width, unsigned height, const TerrainNoiseSettings &settings) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash_value(hash, terrain_cache_versionCE);
+    hash_value(hash, width);
+    hash_value(hash, height);
+    hash_value(hash, settings.seed);
+    hash_value(hash, settings.frequency);
+    hash_value(hash, settings.octaves);
+    hash_value(hash, settings.lacunarity);
+    hash_value(hash, settings.gain);
+    hash_value(hash, settings.weighted_strength);
+    hash_value(hash, settings.sigmoid_factor);
+    return hash;
+}
+
+std::string TerrainCache::get_path(unsigned width, unsigned height, const TerrainNoiseSettings &settings) const {
+    std::ostringstream name;
+    name << "terrain_" << width << 'x' << height << '_'
+         << std::hex << std::setw(16) << std::setfill('0') << get_key(width, height, settings) << ".cqt";
+    return (std::filesystem::path {directory} / name.str()).string();
+}
+
+bool TerrainCache::load(unsigned width, unsigned height, const TerrainNoiseSettings &settings, const RowReader &store_row) const {
+    if (!is_enabled())
+        return false;
+
+    FileContents file;
+    if (!file.open(get_path(width, height, settings)))
+        return false;
+
+    size_t tile_count = (size_t)width * height;
+    if (file.get_size() != sizeof(TerrainCacheHeader) + tile_count * 2) {
+        CQ_LOG_RELEASE_ERROR << "Ignoring terrain cache with the wrong size: " << get_path(width, height, settings) << '\n';
+        return false;
+    }
+    TerrainCacheHeader header;
+    std::memcpy(&header, file.get_data(), sizeof(header));
+    if (header.magic != terrain_cache_magicCE || header.version != terrain_cache_versionCE ||
+            header.width != width || header.height != height || header.key != get_key(width, height, settings)) {
+        CQ_LOG_RELEASE_ERROR << "Ignoring outdated terrain cache: " << get_path(width, height, settings) << '\n';
+        return false;
+    }
+
+    const unsigned char *file_elevations = file.get_data() + sizeof(header);
+    if (!std::all_of(file_elevations + tile_count, file_elevations + tile_count * 2, is_map_tile_type)) {
+        CQ_LOG_RELEASE_ERROR << "Ignoring terrain cache with invalid tile types: " << get_path(width, height, settings) << '\n';
+        return false;
+    }
+
+    // the file has no water ring, so it is copied a row at a time
+    const MapTileType *file_types = reinterpret_cast<const MapTileType *>(file_elevations + tile_count);
+    for (size_t y = 0; y < height; y++)
+        store_row(y, file_elevations + y * width, file_types + y * width);
+    return true;
+}
+
+bool TerrainCache::save(unsigned width, unsigned height, const TerrainNoiseSettings &settings, const RowWriter &fill_row) const {
+    if (!is_enabled())
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        CQ_LOG_RELEASE_ERROR << "Could not create the terrain cache directory " << directory << ": " << error.message() << '\n';
+        return false;
+    }
+
+    TerrainCacheHeader header {terrain_cache_magicCE, terrain_cache_versionCE, width, height, get_key(width, height, settings)};
+
+    // write to a temporary file first so other matches never see half a file
+    std::string path = get_path(width, height, settings);
+    std::string temporary_path = get_temporary_path(path);
+    {
+        std::ofstream file {temporary_path, std::ios::binary | std::ios::trunc};
+        // the planes are gathered first since the file has all the elevations before the types
+        size_t tile_count = (size_t)width * height;
+        std::vector<uint8_t> elevations(tile_count);
+        std::vector<MapTileType> types(tile_count);
+        for (size_t y = 0; y < height; y++)
+            fill_row(y, elevations.data() + y * width, types.data() + y * width);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(elevations.data()), tile_count);
+        file.write(reinterpret_cast<const char *>(types.data()), tile_count);
+        if (!file) {
+            CQ_LOG_RELEASE_ERROR << "Could not write the terrain cache " << temporary_path << '\n';
+            file.close();
+            std::filesystem::remove(temporary_path, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary_path, path, error);
+    if (error) {
+        CQ_LOG_RELEASE_ERROR << "Could not write the terrain cache " << path << ": " << error.message() << '\n';
+        std::filesystem::remove(temporary_path, error);
+        return false;
+    }
+    return true;
+}
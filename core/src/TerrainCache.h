@@ -0,0 +1,51 @@
+#pragma once
+
+#include "MapTileTypes.h"
+#include "noise_wrapper.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// "CQTC" in a little endian file
+constexpr uint32_t terrain_cache_magicCE = 0x43545143;
+// must be increased whenever the file layout or the terrain generation changes
+// (2: the AVX2 elevations became the same as the scalar ones)
+constexpr uint32_t terrain_cache_versionCE = 2;
+
+// Stores generated terrain on disk so the same map does not have to be generated again.
+// There is one file per map size and terrain settings:
+//
+//   header (terrain_cache_magicCE, terrain_cache_versionCE, width, height, key)
+//   elevation plane (width * height bytes, row by row)
+//   type plane (width * height bytes, row by row)
+//
+// Files are read with mmap where it is available. A file with the wrong magic,
+// version, size or key, or with a byte in the type plane that is not a MapTileType,
+// is ignored (and overwritten by the next save). Every save writes its own temporary
+// file and renames it into place, so matches saving the same terrain at the same time
+// never mix their files.
+class TerrainCache {
+    std::string directory;
+
+public:
+    // an empty directory disables the cache
+    explicit TerrainCache(std::string directory);
+
+    bool is_enabled() const;
+
+    // the terrain only depends on these, so they are what the cache is looked up by
+    static uint64_t get_key(unsigned width, unsigned height, const TerrainNoiseSettings &settings);
+    std::string get_path(unsigned width, unsigned height, const TerrainNoiseSettings &settings) const;
+
+    // the file is read and written a row at a time, so it does not depend on how the map lays out its tiles
+    using RowReader = std::function<void(unsigned y, const uint8_t *elevations, const MapTileType *types)>;
+    using RowWriter = std::function<void(unsigned y, uint8_t *elevations, MapTileType *types)>;
+
+    // calls store_row with the width elevations and types of every row
+    // returns false if there is no usable cache file, store_row is not called then
+    bool load(unsigned width, unsigned height, const TerrainNoiseSettings &settings, const RowReader &store_row) const;
+    // calls fill_row to get the width elevations and types of every row
+    // returns false if the file could not be written
+    bool save(unsigned width, unsigned height, const TerrainNoiseSettings &settings, const RowWriter &fill_row) const;
+};
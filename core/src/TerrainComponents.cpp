@@ -0,0 +1,151 @@
+#include "TerrainComponents.h"
+#include "Logging.h"
+#include "Map.h"
+#include "MapTileTypes.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// the tiles [x_begin, x_end) of a row which are all land or all water
+struct TerrainRun {
+    unsigned x_begin;
+    unsigned x_end;
+    unsigned y;
+    bool is_land;
+};
+
+// the root of the run in the union find forest, with path halving
+uint32_t find_root(std::vector<uint32_t> &parents, uint32_t run) {
+    while (parents[run] != run) {
+        parents[run] = parents[parents[run]];
+        run = parents[run];
+    }
+    return run;
+}
+
+} // namespace
+
+void TerrainComponents::build(const Map &map) {
+    unsigned width = map.get_width(), height = map.get_height();
+    components.clear();
+
+    // The map is split into runs of land and water, and runs of the same kind that
+    // touch in 2 rows next to each other are joined with a union find.
+    // There are far fewer runs than tiles, so this is much cheaper than a flood fill.
+    std::vector<TerrainRun> runs;
+    std::vector<uint32_t> parents;
+    // runs of different kinds next to each other, which become the coasts
+    std::vector<std::pair<uint32_t, uint32_t>> run_coasts;
+    size_t previous_begin = 0, previous_end = 0;
+    for (unsigned y = 0; y < height; y++) {
+        auto types = map.get_type_row(y);
+        size_t row_begin = runs.size();
+        for (unsigned x = 0; x < width;) {
+            bool is_land = types[x] != MapTileType::Water;
+            unsigned x_end = x + 1;
+            while (x_end < width && (types[x_end] != MapTileType::Water) == is_land)
+                x_end++;
+            if (runs.size() != row_begin)
+                run_coasts.emplace_back(runs.size() - 1, runs.size());
+            parents.push_back(runs.size());
+            runs.push_back({x, x_end, y, is_land});
+            x = x_end;
+        }
+
+        // the runs of both rows are sorted by x, so the overlapping ones are found like a merge
+        size_t above = previous_begin;
+        for (size_t run = row_begin; run < runs.size() && above < previous_end;) {
+            if (runs[above].is_land == runs[run].is_land)
+                parents[find_root(parents, above)] = find_root(parents, run);
+            else
+                run_coasts.emplace_back(above, run);
+            if (runs[above].x_end < runs[run].x_end)
+                above++;
+            else if (runs[above].x_end > runs[run].x_end)
+                run++;
+            else {
+                above++;
+                run++;
+            }
+        }
+        previous_begin = row_begin;
+        previous_end = runs.size();
+    }
+
+    // the components are numbered in the order their first tile comes in the rows
+    std::vector<ComponentId> run_components(runs.size());
+    std::vector<ComponentId> root_components(runs.size(), no_componentCE);
+    for (size_t run = 0; run < runs.size(); run++) {
+        uint32_t root = find_root(parents, run);
+        if (root_components[root] == no_componentCE) {
+            root_components[root] = components.size();
+            components.push_back({runs[run].is_land, 0, {runs[run].x_begin, runs[run].y, runs[run].x_end, runs[run].y + 1}, {}});
+        }
+        run_components[run] = root_components[root];
+    }
+
+    // the water ring (and the padding of the Morton layout) stays no_componentCE,
+    // so 2 lakes on the edge of the map are not connected through it
+    labels.assign(map.get_tile_index_count(), no_componentCE);
+    for (size_t run = 0; run < runs.size(); run++) {
+        const TerrainRun &tiles = runs[run];
+        ComponentId component = run_components[run];
+        TerrainComponent &info = components[component];
+        info.tile_count += tiles.x_end - tiles.x_begin;
+        info.bounds.x_begin = std::min(info.bounds.x_begin, tiles.x_begin);
+        info.bounds.x_end = std::max(info.bounds.x_end, tiles.x_end);
+        info.bounds.y_end = tiles.y + 1;
+        if (map.get_layout() == TileLayout::RowMajor) {
+            std::fill_n(labels.begin() + map.get_tile_index(tiles.x_begin, tiles.y), tiles.x_end - tiles.x_begin, component);
+            continue;
+        }
+        for (unsigned x = tiles.x_begin; x < tiles.x_end; x++)
+            labels[map.get_tile_index(x, tiles.y)] = component;
+    }
+
+    std::vector<std::pair<ComponentId, ComponentId>> coasts;
+    coasts.reserve(run_coasts.size());
+    for (auto [a, b] : run_coasts) {
+        ComponentId a_component = run_components[a], b_component = run_components[b];
+        coasts.emplace_back(std::min(a_component, b_component), std::max(a_component, b_component));
+    }
+    std::sort(coasts.begin(), coasts.end());
+    coasts.erase(std::unique(coasts.begin(), coasts.end()), coasts.end());
+    // coasts is sorted, so adding the smaller neighbors of every component first
+    // and then the bigger ones keeps the neighbors sorted
+    for (auto [a, b] : coasts)
+        components[b].neighbors.push_back(a);
+    for (auto [a, b] : coasts)
+        components[a].neighbors.push_back(b);
+
+    CQ_LOG_DEBUG << "Found " << components.size() << " landmasses and bodies of water\n";
+}
+
+const TerrainComponent &TerrainComponents::get_info(ComponentId component) const {
+    return components[component];
+}
+
+size_t TerrainComponents::get_component_count() const {
+    return components.size();
+}
+
+bool TerrainComponents::are_connected(TileIndex a, TileIndex b) const {
+    return labels[a] != no_componentCE && labels[a] == labels[b];
+}
+
+bool TerrainComponents::are_connected_by_water(ComponentId a, ComponentId b) const {
+    // both lists are sorted, so this walks them once like a merge
+    const auto &a_neighbors = components[a].neighbors;
+    const auto &b_neighbors = components[b].neighbors;
+    auto a_it = a_neighbors.begin(), b_it = b_neighbors.begin();
+    while (a_it != a_neighbors.end() && b_it != b_neighbors.end()) {
+        if (*a_it == *b_it)
+            return true;
+        if (*a_it < *b_it)
+            ++a_it;
+        else
+            ++b_it;
+    }
+    return false;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ChunkIndex.h"
+#include "typedefs.h"
+#include <cstdint>
+#include <vector>
+
+class Map;
+
+typedef uint32_t ComponentId;
+// the component of the tiles outside of the map
+constexpr ComponentId no_componentCE = UINT32_MAX;
+
+// a landmass or a body of water
+struct TerrainComponent {
+    bool is_land;
+    unsigned tile_count;
+    // the smallest area with every tile of the component
+    TileArea bounds;
+    // the components of the other kind that touch this one (the coasts), sorted
+    std::vector<ComponentId> neighbors;
+};
+
+// Labels every tile of the map with the landmass or body of water it is part of
+// (tiles connected through their 4 neighbors, land with land and water with water).
+// The terrain never changes, so this is built once with the map and questions
+// like "are these 2 tiles on the same landmass" are a compare of 2 labels.
+class TerrainComponents {
+    // indexed by TileIndex
+    std::vector<ComponentId> labels;
+    std::vector<TerrainComponent> components;
+
+public:
+    TerrainComponents() = default;
+
+    // labels every tile of the map, this is O(size of the map)
+    void build(const Map &map);
+
+    ComponentId get_component(TileIndex tile) const { return labels[tile]; }
+    const TerrainComponent &get_info(ComponentId component) const;
+    size_t get_component_count() const;
+
+    bool are_connected(TileIndex a, TileIndex b) const;
+    // true if a body of water touches both components (which are landmasses)
+    bool are_connected_by_water(ComponentId a, ComponentId b) const;
+};
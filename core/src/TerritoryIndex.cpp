@@ -0,0 +1,46 @@
+#include "TerritoryIndex.h"
+
+void TerritoryIndex::reset(TileIndex tile_count) {
+    slots.assign(tile_count, 0);
+    for (auto &country_tiles : tiles)
+        country_tiles.clear();
+}
+
+bool TerritoryIndex::insert(CountryId country, TileIndex tile) {
+    if (contains(country, tile))
+        return false;
+
+    auto &country_tiles = tiles[country];
+    slots[tile] = country_tiles.size();
+    country_tiles.push_back(tile);
+    return true;
+}
+
+bool TerritoryIndex::erase(CountryId country, TileIndex tile) {
+    if (!contains(country, tile))
+        return false;
+
+    // move the last tile into the hole left by the erased one
+    auto &country_tiles = tiles[country];
+    TileIndex slot = slots[tile];
+    TileIndex last = country_tiles.back();
+    country_tiles[slot] = last;
+    slots[last] = slot;
+    country_tiles.pop_back();
+    return true;
+}
+
+bool TerritoryIndex::contains(CountryId country, TileIndex tile) const {
+    const auto &country_tiles = tiles[country];
+    TileIndex slot = slots[tile];
+    return slot < country_tiles.size() && country_tiles[slot] == tile;
+}
+
+size_t TerritoryIndex::size(CountryId country) const {
+    return tiles[country].size();
+}
+
+const std::vector<TileIndex> &TerritoryIndex::get_tiles(CountryId country) const {
+    return tiles[country];
+}
+
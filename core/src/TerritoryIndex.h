@@ -0,0 +1,36 @@
+#pragma once
+
+#include "typedefs.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// A set of tiles for every country, where a tile can only
+// be in the set of one country at a time (like ownership).
+// It is a sparse set: the tiles of each country are packed in
+// a vector and every tile remembers its slot in that vector,
+// so insert, erase and contains are all O(1) and iterating
+// over the tiles of a country is just walking an array.
+class TerritoryIndex {
+    // the position of each tile in the tiles vector of the country that has it
+    std::vector<TileIndex> slots;
+    std::array<std::vector<TileIndex>, country_id_countCE> tiles;
+
+public:
+    TerritoryIndex() = default;
+
+    // removes every tile and makes room for tile_count tiles
+    void reset(TileIndex tile_count);
+
+    // returns false if the country already had the tile
+    // the tile must not be in the set of another country
+    bool insert(CountryId country, TileIndex tile);
+    // returns false if the country did not have the tile
+    bool erase(CountryId country, TileIndex tile);
+    bool contains(CountryId country, TileIndex tile) const;
+
+    size_t size(CountryId country) const;
+    // the order of the tiles changes whenever a tile is erased
+    const std::vector<TileIndex> &get_tiles(CountryId country) const;
+};
+
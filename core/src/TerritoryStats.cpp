@@ -0,0 +1,107 @@
+#include "TerritoryStats.h"
+#include "Logging.h"
+#include "Map.h"
+#include "TerritoryIndex.h"
+#include <algorithm>
+
+unsigned get_map_tile_type_slot(MapTileType type) {
+    switch (type) {
+        case MapTileType::Water:
+            return 0;
+        case MapTileType::Beach:
+            return 1;
+        case MapTileType::Grass:
+            return 2;
+        case MapTileType::Hill:
+            return 3;
+        case MapTileType::Mountain:
+            return 4;
+    }
+    CQ_LOG_DIST_ERROR << "Unknown map tile type: " << static_cast<int>(type) << '\n';
+    return 0;
+}
+
+unsigned CountryTerritory::get_type_count(MapTileType type) const {
+    return type_counts[get_map_tile_type_slot(type)];
+}
+
+float CountryTerritory::get_centroid_x() const {
+    if (tile_count == 0)
+        return 0;
+    return (double)x_sum / tile_count + 0.5;
+}
+
+float CountryTerritory::get_centroid_y() const {
+    if (tile_count == 0)
+        return 0;
+    return (double)y_sum / tile_count + 0.5;
+}
+
+void TerritoryStats::reset() {
+    countries.fill({});
+}
+
+void TerritoryStats::transfer(const Map &map, Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner) {
+    if (old_owner == new_owner)
+        return;
+
+    CountryTerritory *loser = old_owner != 0 ? &countries[old_owner] : nullptr;
+    CountryTerritory *gainer = new_owner != 0 ? &countries[new_owner] : nullptr;
+    for (TileIndex tile : tiles) {
+        auto [x, y] = map.get_tile_coors(tile);
+        unsigned type_slot = get_map_tile_type_slot(map.get_type(tile));
+
+        if (loser) {
+            CONQORIAL_DEBUG_ASSERT(loser->tile_count != 0, std::string("A country without tiles lost a tile"));
+            loser->tile_count--;
+            loser->type_counts[type_slot]--;
+            loser->x_sum -= x;
+            loser->y_sum -= y;
+            const TileArea &bounds = loser->bounds;
+            if (loser->tile_count == 0) {
+                loser->bounds = {0, 0, 0, 0};
+                loser->bounds_may_shrink = false;
+            } else if (x == bounds.x_begin || x + 1u == bounds.x_end || y == bounds.y_begin || y + 1u == bounds.y_end)
+                loser->bounds_may_shrink = true;
+        }
+
+        if (gainer) {
+            if (gainer->tile_count == 0)
+                gainer->bounds = {x, y, x + 1u, y + 1u};
+            else {
+                TileArea &bounds = gainer->bounds;
+                bounds.x_begin = std::min<unsigned>(bounds.x_begin, x);
+                bounds.y_begin = std::min<unsigned>(bounds.y_begin, y);
+                bounds.x_end = std::max(bounds.x_end, x + 1u);
+                bounds.y_end = std::max(bounds.y_end, y + 1u);
+            }
+            gainer->tile_count++;
+            gainer->type_counts[type_slot]++;
+            gainer->x_sum += x;
+            gainer->y_sum += y;
+        }
+    }
+}
+
+void TerritoryStats::shrink_bounds(const Map &map, const TerritoryIndex &territory) {
+    for (unsigned country = 1; country < country_id_countCE; country++) {
+        CountryTerritory &stats = countries[country];
+        if (!stats.bounds_may_shrink)
+            continue;
+
+        TileArea bounds {UINT32_MAX, UINT32_MAX, 0, 0};
+        for (TileIndex tile : territory.get_tiles(country)) {
+            auto [x, y] = map.get_tile_coors(tile);
+            bounds.x_begin = std::min<unsigned>(bounds.x_begin, x);
+            bounds.y_begin = std::min<unsigned>(bounds.y_begin, y);
+            bounds.x_end = std::max(bounds.x_end, x + 1u);
+            bounds.y_end = std::max(bounds.y_end, y + 1u);
+        }
+        stats.bounds = bounds;
+        stats.bounds_may_shrink = false;
+    }
+}
+
+const CountryTerritory &TerritoryStats::get(CountryId country) const {
+    return countries[country];
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ChunkIndex.h"
+#include "MapTileTypes.h"
+#include "Span.h"
+#include "typedefs.h"
+#include <array>
+#include <cstdint>
+
+class Map;
+class TerritoryIndex;
+
+constexpr unsigned map_tile_type_countCE = 5;
+
+// the position of the type in CountryTerritory::type_counts
+unsigned get_map_tile_type_slot(MapTileType type);
+
+// the totals of the tiles owned by a country
+struct CountryTerritory {
+    unsigned tile_count = 0;
+    // indexed by get_map_tile_type_slot
+    std::array<unsigned, map_tile_type_countCE> type_counts {};
+    // the sums of the coordinates of every tile, for the centroid
+    uint64_t x_sum = 0;
+    uint64_t y_sum = 0;
+    // every tile is inside, but after the country lost tiles on its edge the area
+    // can be bigger than needed until TerritoryStats::shrink_bounds is called
+    TileArea bounds {0, 0, 0, 0};
+    bool bounds_may_shrink = false;
+
+    unsigned get_type_count(MapTileType type) const;
+    // the center of the tiles (tile x covers [x, x + 1)), 0 if there are no tiles
+    float get_centroid_x() const;
+    float get_centroid_y() const;
+};
+
+// The territory totals of every country, updated with each ownership change
+// so the economy, the AI and the UI can read them in O(1) instead of walking
+// the tiles of a country.
+// The neutral country is not counted.
+class TerritoryStats {
+    std::array<CountryTerritory, country_id_countCE> countries;
+
+public:
+    TerritoryStats() = default;
+
+    void reset();
+    // the tiles must all be owned by old_owner, they are counted for new_owner after this
+    void transfer(const Map &map, Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner);
+    // makes the bounds exact again for the countries that lost tiles on their edge,
+    // this walks the tiles of those countries only
+    void shrink_bounds(const Map &map, const TerritoryIndex &territory);
+
+    const CountryTerritory &get(CountryId country) const;
+};
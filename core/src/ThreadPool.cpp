@@ -0,0 +1,83 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+    thread_count = resolve_thread_count(thread_count);
+    for (unsigned i = 1; i < thread_count; i++)
+        workers.emplace_back(&ThreadPool::worker_loop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+unsigned ThreadPool::get_thread_count() const {
+    return workers.size() + 1;
+}
+
+unsigned ThreadPool::resolve_thread_count(unsigned thread_count) {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    return 1;
+#else
+    if (thread_count == 0)
+        thread_count = std::thread::hardware_concurrency();
+    return thread_count == 0 ? 1 : thread_count;
+#endif
+}
+
+void ThreadPool::run_band(unsigned thread_index) {
+    unsigned long long thread_count = get_thread_count();
+    unsigned begin = job_count * thread_index / thread_count;
+    unsigned end = job_count * (thread_index + 1) / thread_count;
+    if (begin < end)
+        (*job)(begin, end);
+}
+
+void ThreadPool::worker_loop(unsigned worker_index) {
+    unsigned long long last_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+            work_ready.wait(lock, [&] { return stopping || job_generation != last_generation; });
+            if (stopping)
+                return;
+            last_generation = job_generation;
+        }
+
+        run_band(worker_index);
+
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            workers_busy--;
+        }
+        work_done.notify_one();
+    }
+}
+
+void ThreadPool::parallel_for(unsigned count, const std::function<void(unsigned begin, unsigned end)> &function) {
+    if (workers.empty()) {
+        if (count != 0)
+            function(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        job = &function;
+        job_count = count;
+        workers_busy = workers.size();
+        job_generation++;
+    }
+    work_ready.notify_all();
+
+    run_band(0);
+
+    std::unique_lock<std::mutex> lock {mutex};
+    work_done.wait(lock, [&] { return workers_busy == 0; });
+    job = nullptr;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that split ranges of work between them.
+// The thread that calls parallel_for works on a part of the range too,
+// so a pool of 1 thread never starts a worker.
+class ThreadPool {
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    // incremented every time a new job is given to the workers
+    unsigned long long job_generation = 0;
+    unsigned workers_busy = 0;
+    bool stopping = false;
+
+    const std::function<void(unsigned, unsigned)> *job = nullptr;
+    unsigned job_count = 0;
+
+    void worker_loop(unsigned worker_index);
+    // the part of [0, job_count) the thread with that index works on
+    void run_band(unsigned thread_index);
+
+public:
+    // 0 means one thread per core
+    explicit ThreadPool(unsigned thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // including the thread that calls parallel_for
+    unsigned get_thread_count() const;
+
+    // calls function(begin, end) on contiguous parts of [0, count), one per thread,
+    // and returns once all of them are done
+    void parallel_for(unsigned count, const std::function<void(unsigned begin, unsigned end)> &function);
+
+    // the number of threads a pool of thread_count threads would really use
+    // this is always 1 when threads are not available (eg. Emscripten without pthreads)
+    static unsigned resolve_thread_count(unsigned thread_count);
+};
+
@@ -0,0 +1,51 @@
+#include "TileChangeJournal.h"
+#include "Logging.h"
+#include <algorithm>
+
+static size_t round_up_to_power_of_two(size_t value) {
+    size_t power = 1;
+    while (power < value)
+        power *= 2;
+    return power;
+}
+
+TileChangeJournal::TileChangeJournal(size_t capacity)
+    : changes(round_up_to_power_of_two(capacity)), mask(changes.size() - 1) {}
+
+void TileChangeJournal::publish(SimulationTick tick, Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner) {
+    // only the last capacity changes would survive anyway
+    size_t first = tiles.size() > changes.size() ? tiles.size() - changes.size() : 0;
+    end += first;
+    for (size_t i = first; i < tiles.size(); i++) {
+        changes[end & mask] = {tick, tiles[i], old_owner, new_owner};
+        end++;
+    }
+}
+
+size_t TileChangeJournal::get_capacity() const {
+    return changes.size();
+}
+
+TileChangeJournal::Cursor TileChangeJournal::get_cursor() const {
+    return end;
+}
+
+TileChangeJournal::Delta TileChangeJournal::read(Cursor &cursor) const {
+    CONQORIAL_ASSERT_ALL(cursor <= end, "A tile change cursor is ahead of the journal",
+            std::cerr << "Cursor: " << cursor << ", end: " << end << '\n'; cursor = end;);
+
+    Delta delta;
+    if (end - cursor > changes.size()) {
+        delta.overflowed = true;
+        cursor = end;
+        return delta;
+    }
+
+    size_t begin_slot = cursor & mask;
+    size_t count = end - cursor;
+    size_t first_count = std::min(count, changes.size() - begin_slot);
+    delta.first = {changes.data() + begin_slot, first_count};
+    delta.second = {changes.data(), count - first_count};
+    cursor = end;
+    return delta;
+}
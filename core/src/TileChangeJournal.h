@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Span.h"
+#include "typedefs.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// a tile that changed owner during a simulation tick
+struct TileChange {
+    SimulationTick tick;
+    TileIndex tile;
+    CountryId old_owner;
+    CountryId new_owner;
+};
+
+constexpr size_t default_tile_journal_capacityCE = 1 << 18;
+
+// Every ownership change of a match, in the order they happened, in a ring buffer
+// of the last capacity changes.
+// Every consumer (the texture, the labels, ...) keeps its own cursor and reads the
+// changes since its last read without copying them. A consumer that falls more than
+// capacity changes behind is told so and has to read the whole map again.
+class TileChangeJournal {
+    // change number n is at changes[n & mask]
+    std::vector<TileChange> changes;
+    uint64_t mask;
+    // the number of changes ever published, which is the number of the next one
+    uint64_t end = 0;
+
+public:
+    // the number of the next change a consumer reads
+    typedef uint64_t Cursor;
+
+    struct Delta {
+        // the changes since the last read were overwritten,
+        // first and second are empty and everything has to be read again
+        bool overflowed = false;
+        // the changes in order, split in 2 where the ring wraps around
+        Span<const TileChange> first;
+        Span<const TileChange> second;
+
+        size_t size() const { return first.size() + second.size(); }
+        bool empty() const { return size() == 0 && !overflowed; }
+
+        template<typename Function>
+        void for_each(Function &&function) const {
+            for (const TileChange &change : first)
+                function(change);
+            for (const TileChange &change : second)
+                function(change);
+        }
+    };
+
+    // capacity is rounded up to a power of two
+    explicit TileChangeJournal(size_t capacity = default_tile_journal_capacityCE);
+
+    void publish(SimulationTick tick, Span<const TileIndex> tiles, CountryId old_owner, CountryId new_owner);
+
+    size_t get_capacity() const;
+    // a cursor after every change published so far
+    Cursor get_cursor() const;
+    // the changes after cursor, cursor is moved after them
+    // the spans stay valid until the next publish
+    Delta read(Cursor &cursor) const;
+};
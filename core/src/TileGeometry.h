@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+// how Map turns coordinates into tile indices
+enum class TileLayout : uint8_t {
+    // row after row, with a ring of water tiles around the map
+    RowMajor,
+    // Z-order: the bits of x and y are interleaved, so tiles that are close
+    // in 2D (also vertically) are mostly close in memory
+    Morton,
+};
+
+// Morton codes of the tiles of a side x side square (side is a power of two, at most 2^15)
+// Tiles outside of the square have no code, their neighbors are the sentinel
+// index side * side instead, which the map keeps as a water tile nobody owns.
+class MortonGeometry {
+    uint32_t side = 1;
+    // the bits of the code that belong to x and y
+    uint32_t x_mask = 0;
+    uint32_t y_mask = 0;
+
+    // puts a 0 bit between every bit of the low 16 bits of value
+    static uint32_t spread_bits(uint32_t value) {
+        value &= 0x0000ffff;
+        value = (value | (value << 8)) & 0x00ff00ff;
+        value = (value | (value << 4)) & 0x0f0f0f0f;
+        value = (value | (value << 2)) & 0x33333333;
+        value = (value | (value << 1)) & 0x55555555;
+        return value;
+    }
+
+    // the opposite of spread_bits
+    static uint32_t compact_bits(uint32_t value) {
+        value &= 0x55555555;
+        value = (value | (value >> 1)) & 0x33333333;
+        value = (value | (value >> 2)) & 0x0f0f0f0f;
+        value = (value | (value >> 4)) & 0x00ff00ff;
+        value = (value | (value >> 8)) & 0x0000ffff;
+        return value;
+    }
+
+public:
+    MortonGeometry() = default;
+    explicit MortonGeometry(uint32_t side)
+        : side(side), x_mask(0x55555555 & (side * side - 1)), y_mask(0xaaaaaaaa & (side * side - 1)) {}
+
+    uint32_t get_side() const { return side; }
+    uint32_t get_sentinel() const { return side * side; }
+
+    uint32_t encode(uint32_t x, uint32_t y) const {
+        return spread_bits(x) | (spread_bits(y) << 1);
+    }
+
+    // x and y
+    std::pair<uint32_t, uint32_t> decode(uint32_t code) const {
+        return { compact_bits(code), compact_bits(code >> 1) };
+    }
+
+    // right, left, down and up, like the other layout
+    // x + 1 is done on the x bits alone by setting the y bits so the carry skips them
+    std::array<uint32_t, 4> get_neighbors(uint32_t code) const {
+        uint32_t x = code & x_mask, y = code & y_mask;
+        uint32_t sentinel = get_sentinel();
+        return {
+            x == x_mask ? sentinel : (((code | y_mask) + 1) & x_mask) | y,
+            x == 0 ? sentinel : ((x - 1) & x_mask) | y,
+            y == y_mask ? sentinel : (((code | x_mask) + 1) & y_mask) | x,
+            y == 0 ? sentinel : ((y - 1) & y_mask) | x,
+        };
+    }
+};
@@ -1,9 +1,30 @@
 #include "noise_wrapper.h"
+#include "Logging.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CONQORIAL_NOISE_AVX2
+#include <immintrin.h>
+#endif
 
 double stretch_sigmoid(double x, double factor) {
     return x / (1.0 - factor * (1.0 - std::abs(x)));
 }
 
+void configure_noise(FastNoiseLite &noise, const TerrainNoiseSettings &settings) {
+    noise.SetSeed(settings.seed);
+    noise.SetFrequency(settings.frequency);
+    noise.SetNoiseType(FastNoiseLite::NoiseType::NoiseType_Perlin);
+    noise.SetFractalType(FastNoiseLite::FractalType_FBm);
+    noise.SetFractalOctaves(settings.octaves);
+    noise.SetFractalLacunarity(settings.lacunarity);
+    noise.SetFractalGain(settings.gain);
+    noise.SetFractalWeightedStrength(settings.weighted_strength);
+}
+
 double get_raw_noise(const FastNoiseLite &noise, double x, double y) {
     return (stretch_sigmoid(noise.GetNoise(x, y), 0.6) + 1) / 2;
 }
@@ -12,3 +33,273 @@ double get_elevation(const FastNoiseLite& noise, double x, double y) {
     return get_raw_noise(noise, x, y);
 }
 
+// The batch version of FastNoiseLite's 2D Perlin FBm.
+// The hashing, the gradients and the constants are the same as FastNoiseLite,
+// so both give the same terrain.
+namespace {
+
+constexpr uint32_t prime_xCE = 501125321;
+constexpr uint32_t prime_yCE = 1136930381;
+constexpr uint32_t hash_multiplierCE = 0x27d4eb2d;
+constexpr float perlin_scaleCE = 1.4247691104677813f;
+
+// FastNoiseLite's 128 gradients are these 24 directions repeated 5 times
+// followed by the 8 directions of gradient_diagonalsCE
+constexpr float gradient_directionsCE[24 * 2] = {
+    0.130526192220052f, 0.99144486137381f, 0.38268343236509f, 0.923879532511287f, 0.608761429008721f, 0.793353340291235f, 0.793353340291235f, 0.608761429008721f,
+    0.923879532511287f, 0.38268343236509f, 0.99144486137381f, 0.130526192220051f, 0.99144486137381f, -0.130526192220051f, 0.923879532511287f, -0.38268343236509f,
+    0.793353340291235f, -0.60876142900872f, 0.608761429008721f, -0.793353340291235f, 0.38268343236509f, -0.923879532511287f, 0.130526192220052f, -0.99144486137381f,
+    -0.130526192220052f, -0.99144486137381f, -0.38268343236509f, -0.923879532511287f, -0.608761429008721f, -0.793353340291235f, -0.793353340291235f, -0.608761429008721f,
+    -0.923879532511287f, -0.38268343236509f, -0.99144486137381f, -0.130526192220052f, -0.99144486137381f, 0.130526192220051f, -0.923879532511287f, 0.38268343236509f,
+    -0.793353340291235f, 0.608761429008721f, -0.608761429008721f, 0.793353340291235f, -0.38268343236509f, 0.923879532511287f, -0.130526192220052f, 0.99144486137381f,
+};
+constexpr float gradient_diagonalsCE[8 * 2] = {
+    0.38268343236509f, 0.923879532511287f, 0.923879532511287f, 0.38268343236509f, 0.923879532511287f, -0.38268343236509f, 0.38268343236509f, -0.923879532511287f,
+    -0.38268343236509f, -0.923879532511287f, -0.923879532511287f, -0.38268343236509f, -0.923879532511287f, 0.38268343236509f, -0.38268343236509f, 0.923879532511287f,
+};
+
+struct GradientTable {
+    float x[128];
+    float y[128];
+
+    GradientTable() {
+        for (unsigned i = 0; i < 120; i++) {
+            x[i] = gradient_directionsCE[(i % 24) * 2];
+            y[i] = gradient_directionsCE[(i % 24) * 2 + 1];
+        }
+        for (unsigned i = 120; i < 128; i++) {
+            x[i] = gradient_diagonalsCE[(i - 120) * 2];
+            y[i] = gradient_diagonalsCE[(i - 120) * 2 + 1];
+        }
+    }
+};
+const GradientTable gradients;
+
+float interpolate_quintic(float t) {
+    return t * t * t * (t * (t * 6 - 15) + 10);
+}
+
+float lerp(float a, float b, float t) {
+    return a + t * (b - a);
+}
+
+// the same as FastNoiseLite::FastFloor
+int32_t fast_floor(double value) {
+    return value >= 0 ? (int32_t)value : (int32_t)value - 1;
+}
+
+// what an octave needs to know about the current row
+struct RowOctave {
+    // the seed xored with the primed y of the cells above and below
+    uint32_t seed_cell0;
+    uint32_t seed_cell1;
+    float offset0;
+    float offset1;
+    float weight;
+};
+
+// everything the kernels need to fill a row
+struct RowContext {
+    const uint32_t *column_cells;
+    const float *column_offsets;
+    const float *column_weights;
+    const RowOctave *octaves;
+    unsigned width;
+    int octave_count;
+    float fractal_bounding;
+    float gain;
+    float weighted_strength;
+    double sigmoid_factor;
+};
+
+// hash_input is seed ^ x_primed ^ y_primed
+float gradient(uint32_t hash_input, float xd, float yd) {
+    uint32_t hash = hash_input * hash_multiplierCE;
+    hash ^= hash >> 15;
+    unsigned index = (hash >> 1) & 127;
+    return xd * gradients.x[index] + yd * gradients.y[index];
+}
+
+void fill_row_scalar(const RowContext &row, unsigned x_begin, unsigned count, Elevation *out) {
+    for (unsigned i = 0; i < count; i++) {
+        size_t column = x_begin + i;
+        float sum = 0;
+        float amp = row.fractal_bounding;
+        for (int octave = 0; octave < row.octave_count; octave++, column += row.width) {
+            const RowOctave &y = row.octaves[octave];
+            uint32_t x0 = row.column_cells[column];
+            uint32_t x1 = x0 + prime_xCE;
+            float xd0 = row.column_offsets[column];
+            float xd1 = xd0 - 1;
+            float xs = row.column_weights[column];
+
+            float xf0 = lerp(gradient(y.seed_cell0 ^ x0, xd0, y.offset0), gradient(y.seed_cell0 ^ x1, xd1, y.offset0), xs);
+            float xf1 = lerp(gradient(y.seed_cell1 ^ x0, xd0, y.offset1), gradient(y.seed_cell1 ^ x1, xd1, y.offset1), xs);
+            float noise = lerp(xf0, xf1, y.weight) * perlin_scaleCE;
+
+            sum += noise * amp;
+            amp *= lerp(1.0f, std::min(noise + 1, 2.0f) * 0.5f, row.weighted_strength);
+            amp *= row.gain;
+        }
+        out[i] = (stretch_sigmoid(sum, row.sigmoid_factor) + 1) / 2;
+    }
+}
+
+#ifdef CONQORIAL_NOISE_AVX2
+
+// only AVX2 is enabled (not FMA) so the compiler can not fuse the multiplies and adds below,
+// every operation rounds the same way as in fill_row_scalar and the elevations are bit for bit the same
+
+__attribute__((target("avx2")))
+inline __m256 gradient_avx2(__m256i hash_input, __m256 xd, __m256 yd) {
+    __m256i hash = _mm256_mullo_epi32(hash_input, _mm256_set1_epi32(hash_multiplierCE));
+    hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+    __m256i index = _mm256_and_si256(_mm256_srli_epi32(hash, 1), _mm256_set1_epi32(127));
+    __m256 gradient_x = _mm256_i32gather_ps(gradients.x, index, 4);
+    __m256 gradient_y = _mm256_i32gather_ps(gradients.y, index, 4);
+    return _mm256_add_ps(_mm256_mul_ps(xd, gradient_x), _mm256_mul_ps(yd, gradient_y));
+}
+
+__attribute__((target("avx2")))
+inline __m256 lerp_avx2(__m256 a, __m256 b, __m256 t) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+// stretch_sigmoid, then from -1.0 to 1.0 to 0.0 to 1.0, in double precision like the scalar version
+__attribute__((target("avx2")))
+inline __m256d to_elevation_avx2(__m128 sum, __m256d sigmoid_factor) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    __m256d x = _mm256_cvtps_pd(sum);
+    __m256d distance = _mm256_sub_pd(one, _mm256_andnot_pd(_mm256_set1_pd(-0.0), x));
+    __m256d stretched = _mm256_div_pd(x, _mm256_sub_pd(one, _mm256_mul_pd(sigmoid_factor, distance)));
+    return _mm256_div_pd(_mm256_add_pd(stretched, one), _mm256_set1_pd(2.0));
+}
+
+__attribute__((target("avx2")))
+void fill_row_avx2(const RowContext &row, unsigned x_begin, unsigned count, Elevation *out) {
+    const __m256i prime_x = _mm256_set1_epi32(prime_xCE);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 perlin_scale = _mm256_set1_ps(perlin_scaleCE);
+    const __m256 gain = _mm256_set1_ps(row.gain);
+    const __m256 weighted_strength = _mm256_set1_ps(row.weighted_strength);
+    const __m256d sigmoid_factor = _mm256_set1_pd(row.sigmoid_factor);
+
+    unsigned i = 0;
+    for (; i + 8 <= count; i += 8) {
+        size_t column = x_begin + i;
+        __m256 sum = _mm256_setzero_ps();
+        __m256 amp = _mm256_set1_ps(row.fractal_bounding);
+        for (int octave = 0; octave < row.octave_count; octave++, column += row.width) {
+            const RowOctave &y = row.octaves[octave];
+            __m256i x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row.column_cells + column));
+            __m256i x1 = _mm256_add_epi32(x0, prime_x);
+            __m256 xd0 = _mm256_loadu_ps(row.column_offsets + column);
+            __m256 xd1 = _mm256_sub_ps(xd0, one);
+            __m256 xs = _mm256_loadu_ps(row.column_weights + column);
+            __m256i seed_cell0 = _mm256_set1_epi32(y.seed_cell0);
+            __m256i seed_cell1 = _mm256_set1_epi32(y.seed_cell1);
+            __m256 yd0 = _mm256_set1_ps(y.offset0);
+            __m256 yd1 = _mm256_set1_ps(y.offset1);
+
+            __m256 xf0 = lerp_avx2(gradient_avx2(_mm256_xor_si256(seed_cell0, x0), xd0, yd0),
+                                   gradient_avx2(_mm256_xor_si256(seed_cell0, x1), xd1, yd0), xs);
+            __m256 xf1 = lerp_avx2(gradient_avx2(_mm256_xor_si256(seed_cell1, x0), xd0, yd1),
+                                   gradient_avx2(_mm256_xor_si256(seed_cell1, x1), xd1, yd1), xs);
+            __m256 noise = _mm256_mul_ps(lerp_avx2(xf0, xf1, _mm256_set1_ps(y.weight)), perlin_scale);
+
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(noise, amp));
+            __m256 weight = _mm256_mul_ps(_mm256_min_ps(_mm256_add_ps(noise, one), two), half);
+            amp = _mm256_mul_ps(amp, lerp_avx2(one, weight, weighted_strength));
+            amp = _mm256_mul_ps(amp, gain);
+        }
+
+        _mm256_storeu_pd(out + i, to_elevation_avx2(_mm256_castps256_ps128(sum), sigmoid_factor));
+        _mm256_storeu_pd(out + i + 4, to_elevation_avx2(_mm256_extractf128_ps(sum, 1), sigmoid_factor));
+    }
+
+    fill_row_scalar(row, x_begin + i, count - i, out + i);
+}
+
+#endif
+
+TerrainNoiseSettings check_octaves(TerrainNoiseSettings settings) {
+    CONQORIAL_ASSERT_ALL(settings.octaves >= 1 && settings.octaves <= max_terrain_octavesCE, "The terrain has too many octaves",
+            std::cerr << "Octaves: " << settings.octaves << '\n';
+            settings.octaves = std::clamp(settings.octaves, 1, max_terrain_octavesCE););
+    return settings;
+}
+
+} // namespace
+
+ElevationBatch::ElevationBatch(unsigned width, const TerrainNoiseSettings &requested_settings, bool vectorize)
+    : settings(check_octaves(requested_settings)), width(width), vectorized(vectorize && can_vectorize()),
+      column_cells(size_t(settings.octaves) * width), column_offsets(size_t(settings.octaves) * width),
+      column_weights(size_t(settings.octaves) * width) {
+    // the same as FastNoiseLite::CalculateFractalBounding
+    float gain = std::abs(settings.gain);
+    float amp = gain;
+    float amp_fractal = 1.0f;
+    for (int i = 1; i < settings.octaves; i++) {
+        amp_fractal += amp;
+        amp *= gain;
+    }
+    fractal_bounding = 1 / amp_fractal;
+
+    // the coordinates stay in double precision like in FastNoiseLite::GetNoise(double, double)
+    for (unsigned x = 0; x < width; x++) {
+        double coordinate = x * (double)settings.frequency;
+        for (int octave = 0; octave < settings.octaves; octave++) {
+            size_t column = size_t(octave) * width + x;
+            int32_t cell = fast_floor(coordinate);
+            column_cells[column] = (uint32_t)cell * prime_xCE;
+            column_offsets[column] = (float)(coordinate - cell);
+            column_weights[column] = interpolate_quintic(column_offsets[column]);
+            coordinate *= settings.lacunarity;
+        }
+    }
+}
+
+void ElevationBatch::get_row(unsigned y, unsigned x_begin, Span<Elevation> out) const {
+    std::array<RowOctave, max_terrain_octavesCE> octaves;
+    double coordinate = y * (double)settings.frequency;
+    for (int octave = 0; octave < settings.octaves; octave++) {
+        int32_t cell = fast_floor(coordinate);
+        uint32_t seed = settings.seed + octave;
+        uint32_t cell0 = (uint32_t)cell * prime_yCE;
+        RowOctave &row_octave = octaves[octave];
+        row_octave.seed_cell0 = seed ^ cell0;
+        row_octave.seed_cell1 = seed ^ (cell0 + prime_yCE);
+        row_octave.offset0 = (float)(coordinate - cell);
+        row_octave.offset1 = row_octave.offset0 - 1;
+        row_octave.weight = interpolate_quintic(row_octave.offset0);
+        coordinate *= settings.lacunarity;
+    }
+
+    RowContext row {
+        column_cells.data(), column_offsets.data(), column_weights.data(),
+        octaves.data(), width, settings.octaves, fractal_bounding,
+        settings.gain, settings.weighted_strength, settings.sigmoid_factor
+    };
+#ifdef CONQORIAL_NOISE_AVX2
+    if (vectorized) {
+        fill_row_avx2(row, x_begin, out.size(), out.data());
+        return;
+    }
+#endif
+    fill_row_scalar(row, x_begin, out.size(), out.data());
+}
+
+bool ElevationBatch::is_vectorized() const {
+    return vectorized;
+}
+
+bool ElevationBatch::can_vectorize() {
+#ifdef CONQORIAL_NOISE_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+#else
+    return false;
+#endif
+}
@@ -10,10 +10,15 @@ typedef double Elevation;
 // CountryId is an alias for uint8_t.
 // If it is 0, it means no player/ai
 typedef uint8_t CountryId;
+// the number of different values a CountryId can have
+constexpr unsigned country_id_countCE = 256;
 
 typedef uint16_t TileCoor;
 typedef uint32_t TileIndex;
 
+// the number of fixed length steps the simulation of a match has made
+typedef uint64_t SimulationTick;
+
 typedef std::chrono::steady_clock::time_point CQIntervalTimePoint;
 typedef std::chrono::system_clock::time_point CQSystemTimePoint;
 
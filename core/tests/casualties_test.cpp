@@ -0,0 +1,85 @@
+// Checks how PopulationPyramid::remove_casualties spreads the casualties of attacks:
+// exactly the casualties are removed, only from the reproductive age groups,
+// evenly between their men and women, and never more people than there are.
+//
+// usage: Conqorial-CasualtiesTest
+
+#include "PopulationPyramid.h"
+#include <algorithm>
+#include <iostream>
+
+static bool is_reproductive(const PyramidPiece &piece) {
+    return piece.age >= reproductive_age_min && piece.age <= reproductive_age_max;
+}
+
+static unsigned long long count_people(const PopulationPyramid &pyramid) {
+    unsigned long long people = 0;
+    for (const auto &piece : pyramid.get_pieces())
+        people += piece.male_count + piece.female_count;
+    return people;
+}
+
+static bool check_casualties(unsigned casualties) {
+    PopulationPyramid pyramid;
+    const auto before = pyramid.get_pieces();
+    unsigned long long people_before = count_people(pyramid);
+    pyramid.remove_casualties(casualties);
+    const auto &after = pyramid.get_pieces();
+
+    unsigned long long removed = people_before - count_people(pyramid);
+    if (removed != casualties) {
+        std::cerr << casualties << " casualties removed " << removed << " people\n";
+        return false;
+    }
+
+    unsigned long removed_min = ~0ul, removed_max = 0;
+    for (size_t i = 0; i < before.size(); i++) {
+        unsigned long removed_men = before[i].male_count - after[i].male_count;
+        unsigned long removed_women = before[i].female_count - after[i].female_count;
+        if (!is_reproductive(before[i])) {
+            if (removed_men != 0 || removed_women != 0) {
+                std::cerr << casualties << " casualties: people of age " << (unsigned)before[i].age << " died\n";
+                return false;
+            }
+            continue;
+        }
+        removed_min = std::min({removed_min, removed_men, removed_women});
+        removed_max = std::max({removed_max, removed_men, removed_women});
+    }
+    // every group has more people than these casualties, so the split can only differ by the remainder
+    if (removed_max - removed_min > 1) {
+        std::cerr << casualties << " casualties: the groups lost between " << removed_min << " and " << removed_max << " people\n";
+        return false;
+    }
+    return true;
+}
+
+static bool check_too_many_casualties() {
+    PopulationPyramid pyramid;
+    unsigned long long reproductive_people = 0;
+    for (const auto &piece : pyramid.get_pieces()) {
+        if (is_reproductive(piece))
+            reproductive_people += piece.male_count + piece.female_count;
+    }
+    pyramid.remove_casualties(reproductive_people + 1'000);
+    for (const auto &piece : pyramid.get_pieces()) {
+        if (is_reproductive(piece) && (piece.male_count != 0 || piece.female_count != 0)) {
+            std::cerr << "more casualties than people left people of age " << (unsigned)piece.age << " alive\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    bool passed = true;
+    // casualties that do and do not split evenly, and fewer casualties than groups
+    for (unsigned casualties : {0u, 1u, 7u, 15u, 16u, 100u, 12'345u, 1'000'003u})
+        passed &= check_casualties(casualties);
+    std::cerr << "(the next assertion is expected)\n";
+    passed &= check_too_many_casualties();
+    if (!passed)
+        return 1;
+    std::cout << "the casualties are removed evenly from the reproductive age groups\n";
+    return 0;
+}
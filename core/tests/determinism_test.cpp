@@ -0,0 +1,72 @@
+// Plays two matches with the same seed side by side in one process
+// and checks that they stay in the same state.
+//
+// usage: Conqorial-DeterminismTest [width] [height] [seed] [bots] [ticks]
+
+#include "Match.h"
+#include "typedefs.h"
+#include <cstdlib>
+#include <iostream>
+
+static bool same_state(const Match &a, const Match &b) {
+    const Map &map_a = a.get_map();
+    const Map &map_b = b.get_map();
+    if (map_a.get_width() != map_b.get_width() || map_a.get_height() != map_b.get_height()) {
+        std::cerr << "the maps have different sizes\n";
+        return false;
+    }
+    for (unsigned y = 0; y < map_a.get_height(); y++) {
+        for (unsigned x = 0; x < map_a.get_width(); x++) {
+            if (a.get_map_tile(x, y).owner != b.get_map_tile(x, y).owner) {
+                std::cerr << "tile (" << x << ", " << y << ") has different owners\n";
+                return false;
+            }
+        }
+    }
+
+    if (a.get_countries().size() != b.get_countries().size()) {
+        std::cerr << "different number of countries\n";
+        return false;
+    }
+    for (const Country &country_a : a.get_countries()) {
+        CountryId id = country_a.get_id();
+        const Country &country_b = b.get_country(id);
+        if (country_a.get_troops() != country_b.get_troops() ||
+                country_a.get_money() != country_b.get_money() ||
+                country_a.get_economy() != country_b.get_economy() ||
+                country_a.get_pyramid().get_total_population() != country_b.get_pyramid().get_total_population() ||
+                a.get_country_tile_count(id) != b.get_country_tile_count(id)) {
+            std::cerr << "country " << (short)id << " differs\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned width = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 300;
+    unsigned height = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 300;
+    unsigned seed = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 7;
+    unsigned bots = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 20;
+    unsigned ticks = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 2'000;
+
+    MapSettings map_settings;
+    map_settings.terrain.seed = seed;
+    Match first {width, height, seed, bots, map_settings};
+    Match second {width, height, seed, bots, map_settings};
+    first.set_game_started();
+    second.set_game_started();
+
+    // the matches are advanced in turns so any state they share would make them drift apart
+    for (unsigned i = 0; i < ticks; i++) {
+        first.simulate_ticks(1);
+        second.simulate_ticks(1);
+    }
+
+    if (!same_state(first, second)) {
+        std::cerr << "matches with the same seed diverged after " << ticks << " ticks\n";
+        return 1;
+    }
+    std::cout << "matches with the same seed stayed the same for " << ticks << " ticks\n";
+    return 0;
+}
@@ -0,0 +1,64 @@
+// Checks that the map generation gives the same terrain on every machine:
+// the elevations of ElevationBatch (with and without AVX2) and of a generated map
+// must be bit for bit the ones FastNoiseLite gives one tile at a time.
+//
+// usage: Conqorial-ElevationTest [width] [height] [seed]
+
+#include "Map.h"
+#include "noise_wrapper.h"
+#include "typedefs.h"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+static bool same_elevation(Elevation a, Elevation b) {
+    return std::memcmp(&a, &b, sizeof(Elevation)) == 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned width = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024;
+    unsigned height = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    unsigned seed = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1337;
+
+    TerrainNoiseSettings settings;
+    settings.seed = seed;
+    FastNoiseLite noise;
+    configure_noise(noise, settings);
+
+    ElevationBatch scalar {width, settings, false};
+    ElevationBatch vectorized {width, settings};
+    if (!vectorized.is_vectorized())
+        std::cout << "this CPU has no AVX2, only the scalar path is checked\n";
+
+    MapSettings map_settings;
+    map_settings.terrain = settings;
+    Map map {width, height, map_settings};
+
+    std::vector<Elevation> scalar_row(width), vectorized_row(width);
+    unsigned long long mismatches = 0;
+    for (unsigned y = 0; y < height; y++) {
+        scalar.get_row(y, 0, {scalar_row.data(), scalar_row.size()});
+        vectorized.get_row(y, 0, {vectorized_row.data(), vectorized_row.size()});
+        for (unsigned x = 0; x < width; x++) {
+            Elevation expected = get_elevation(noise, x, y);
+            uint8_t expected_elevation = expected * 100;
+            MapTileType expected_type = get_tile_type(expected * 100);
+            TileIndex index = map.get_tile_index(x, y);
+            if (!same_elevation(scalar_row[x], expected) || !same_elevation(vectorized_row[x], expected) ||
+                    map.get_elevation(index) != expected_elevation || map.get_type(index) != expected_type) {
+                if (mismatches++ < 10)
+                    std::cerr << "tile (" << x << ", " << y << ") differs: expected " << expected
+                              << ", scalar " << scalar_row[x] << ", vectorized " << vectorized_row[x] << '\n';
+            }
+        }
+    }
+
+    if (mismatches != 0) {
+        std::cerr << mismatches << " tiles differ from FastNoiseLite\n";
+        return 1;
+    }
+    std::cout << "all " << (unsigned long long)width * height << " tiles match FastNoiseLite\n";
+    return 0;
+}
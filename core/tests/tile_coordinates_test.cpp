@@ -0,0 +1,43 @@
+// Checks that get_tile_coors turns the index of every tile back into its coordinates
+// in every layout, with and without power of two rows.
+//
+// usage: Conqorial-TileCoordinatesTest
+
+#include "Map.h"
+#include "typedefs.h"
+#include <iostream>
+
+static bool check_map(unsigned width, unsigned height, TileLayout layout, bool power_of_two_stride) {
+    MapSettings settings;
+    settings.layout = layout;
+    settings.power_of_two_stride = power_of_two_stride;
+    Map map {width, height, settings};
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++) {
+            TileIndex index = map.get_tile_index(x, y);
+            auto [tile_x, tile_y] = map.get_tile_coors(index);
+            if (index >= map.get_tile_index_count() || tile_x != x || tile_y != y) {
+                std::cerr << width << 'x' << height << (layout == TileLayout::Morton ? " morton" : " row major")
+                          << (power_of_two_stride ? " with power of two rows" : "") << ": tile (" << x << ", " << y
+                          << ") comes back as (" << tile_x << ", " << tile_y << ")\n";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    // 126 + the water ring is already a power of two, 130 is not
+    const unsigned sizes[][2] = { {126, 64}, {130, 70}, {256, 256} };
+    bool passed = true;
+    for (const auto &size : sizes) {
+        passed &= check_map(size[0], size[1], TileLayout::RowMajor, false);
+        passed &= check_map(size[0], size[1], TileLayout::RowMajor, true);
+        passed &= check_map(size[0], size[1], TileLayout::Morton, false);
+    }
+    if (!passed)
+        return 1;
+    std::cout << "every tile index turns back into its coordinates\n";
+    return 0;
+}
@@ -0,0 +1,65 @@
+// Runs a match without the client, as fast as possible, to measure
+// how quickly the simulation itself runs.
+//
+// usage: Conqorial-Headless [width] [height] [seed] [bots] [ticks] [terrain_cache_directory]
+// the seed is used for both the terrain and the match
+
+#include "Match.h"
+#include "typedefs.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace std::chrono;
+
+int main(int argc, char *argv[]) {
+    unsigned width = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 600;
+    unsigned height = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 600;
+    unsigned seed = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 0;
+    unsigned bots = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : default_ai_country_countCE;
+    unsigned ticks = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 2'000;
+    MapSettings map_settings;
+    map_settings.terrain.seed = seed;
+    if (argc > 6)
+        map_settings.terrain_cache_directory = argv[6];
+    if (width == 0 || height == 0 || width > 65'535 || height > 65'535 || bots > country_id_countCE - 2) {
+        std::cerr << "usage: " << argv[0] << " [width] [height] [seed] [bots (0-254)] [ticks] [terrain_cache_directory]\n";
+        return 1;
+    }
+
+    std::cout << "map: " << width << "x" << height << ", seed: " << seed
+              << ", bots: " << bots << ", ticks: " << ticks << '\n';
+
+    auto setup_start = steady_clock::now();
+    Match match {width, height, seed, bots, map_settings};
+    match.set_game_started();
+    double setup_seconds = duration<double>(steady_clock::now() - setup_start).count();
+
+    unsigned long long tiles_changed = 0;
+    auto start = steady_clock::now();
+    for (unsigned i = 0; i < ticks; i++)
+        tiles_changed += match.simulate_ticks(1).size();
+    double seconds = duration<double>(steady_clock::now() - start).count();
+
+    std::cout << "setup: " << setup_seconds << " s\n"
+              << "simulation: " << seconds << " s\n"
+              << "ticks/sec: " << ticks / seconds << '\n'
+              << "tiles changed: " << tiles_changed << '\n'
+              << "tiles changed/sec: " << tiles_changed / seconds << '\n';
+
+    std::cout << '\n' << std::left
+              << std::setw(4) << "id" << std::setw(12) << "name" << std::setw(10) << "tiles"
+              << std::setw(12) << "troops" << std::setw(14) << "population" << std::setw(12) << "money"
+              << "millitary level\n";
+    for (const Country &country : match.get_countries()) {
+        CountryId id = country.get_id();
+        std::cout << std::setw(4) << (short)id << std::setw(12) << country.get_name()
+                  << std::setw(10) << match.get_country_tile_count(id)
+                  << std::setw(12) << country.get_troops()
+                  << std::setw(14) << country.get_pyramid().get_total_population()
+                  << std::setw(12) << country.get_money()
+                  << country.get_millitary_level() << '\n';
+    }
+    return 0;
+}